@@ -0,0 +1,72 @@
+#pragma once
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+
+// Monotonic allocation: Allocate() bumps a pointer in the current block,
+// nothing is freed until Release() drops all the blocks at once.
+// Several threads may allocate from one arena at the same time.
+class Arena {
+public:
+	Arena(size_t blockSize = 64 * 1024);
+	~Arena();
+
+public:
+	void* Allocate(size_t size);
+
+	// No memory of the arena may be used after this.
+	void Release();
+
+private:
+	Arena(const Arena& other);
+	Arena& operator = (const Arena& other);
+
+private:
+	struct Block {
+		Block* next;
+		size_t size;
+		std::atomic<size_t> used;
+	};
+
+	enum {
+		Alignment = 16,
+		HeaderSize = (sizeof(Block) + Alignment - 1) & ~(Alignment - 1),
+	};
+
+private:
+	Block* CreateBlock(size_t size, Block* next);
+
+private:
+	size_t blockSize_;
+	std::mutex mutex_;
+	std::atomic<Block*> current_;
+};
+
+// STL allocator over an arena, deallocate does nothing.
+// Containers using it must be destroyed, or no longer touched, before the arena is released.
+template <class T>
+class ArenaAllocator {
+public:
+	typedef T value_type;
+
+	ArenaAllocator(Arena* arena) : arena_(arena) { }
+
+	template <class U>
+	ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena_) { }
+
+public:
+	T* allocate(size_t n) { return (T*)arena_->Allocate(n * sizeof(T)); }
+	void deallocate(T*, size_t) { }
+
+	template <class U>
+	bool operator == (const ArenaAllocator<U>& other) const { return arena_ == other.arena_; }
+
+	template <class U>
+	bool operator != (const ArenaAllocator<U>& other) const { return arena_ != other.arena_; }
+
+private:
+	template <class U>
+	friend class ArenaAllocator;
+
+	Arena* arena_;
+};
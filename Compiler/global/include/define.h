@@ -10,3 +10,6 @@
 
 // ʽ.
 #define MAX_PARSER_FUNCTION_PARAMTERS	8
+
+// Lookahead sets are bitsets of this width over terminal ids.
+#define MAX_TERMINAL_SYMBOLS			256
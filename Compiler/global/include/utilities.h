@@ -37,6 +37,9 @@ public:
 	static void Split(std::vector<std::string>& answer, const std::string& str, char seperator);
 
 	static std::string Heading(const std::string& text);
+
+	// Estimated bytes of a node of std::map or std::set, whose value takes valueSize bytes.
+	static size_t TreeNodeSize(size_t valueSize);
 private:
 	Utility();
 };
@@ -65,6 +68,11 @@ inline bool Utility::IsLetter(int c) {
 	return (isalpha(c) != 0) || c == '_' || c == '$';
 }
 
+inline size_t Utility::TreeNodeSize(size_t valueSize) {
+	// left, parent and right pointers, and the color and nil flags.
+	return valueSize + 4 * sizeof(void*);
+}
+
 template <class Iterator>
 std::string Utility::Concat(Iterator first, Iterator last, const char* seperator) {
 	const char* sep = "";
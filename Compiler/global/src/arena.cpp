@@ -0,0 +1,50 @@
+#include <new>
+#include <algorithm>
+
+#include "arena.h"
+
+Arena::Arena(size_t blockSize) : blockSize_(blockSize), current_(nullptr) {
+}
+
+Arena::~Arena() {
+	Release();
+}
+
+void* Arena::Allocate(size_t size) {
+	size = (size + Alignment - 1) & ~(size_t)(Alignment - 1);
+
+	for (;;) {
+		Block* block = current_.load(std::memory_order_acquire);
+		if (block != nullptr) {
+			size_t offset = block->used.fetch_add(size);
+			if (offset + size <= block->size) {
+				return (char*)block + HeaderSize + offset;
+			}
+		}
+
+		// the block is full, the first thread here replaces it, the others retry.
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (current_.load(std::memory_order_relaxed) == block) {
+			current_.store(CreateBlock(std::max(blockSize_, size), block), std::memory_order_release);
+		}
+	}
+}
+
+void Arena::Release() {
+	for (Block* block = current_.load(); block != nullptr;) {
+		Block* next = block->next;
+		block->~Block();
+		::operator delete(block);
+		block = next;
+	}
+
+	current_.store(nullptr);
+}
+
+Arena::Block* Arena::CreateBlock(size_t size, Block* next) {
+	Block* block = new (::operator new(HeaderSize + size)) Block;
+	block->next = next;
+	block->size = size;
+	block->used.store(0);
+	return block;
+}
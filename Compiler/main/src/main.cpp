@@ -1,8 +1,11 @@
+#include <cstring>
+
 #include "main.h"
 #include "debug.h"
 #include "utilities.h"
 #include "language.h"
 #include "syntax_tree.h"
+#include "language_test.h"
 
 static const char* demo = "main/debug/demo.js";
 static const char* compiler = "main/config/compiler";
@@ -11,6 +14,11 @@ static const char* productions = "main/config/lr_grammar.txt";
 int main(int argc, char** argv) {
 	Debug::EnableMemoryLeakCheck();
 
+	// "Compiler test" runs the regression tests only.
+	if (argc > 1 && strcmp(argv[1], "test") == 0) {
+		return LanguageTest::Run() ? 0 : 1;
+	}
+
 	Language* lang = new Language;
 	lang->Setup(grammar, compiler);
 
@@ -22,6 +22,9 @@ public:
 	virtual SyntaxNode* Invoke(const std::vector<void*>& container) = 0;
 	virtual bool ParseParameters(TextScanner& scanner, Argument& argument);
 
+	// Whether the action is $$ = $1.
+	virtual bool IsIdentity() const;
+
 private:
 	bool SplitParameters(int* parameters, int& count, TextScanner& scanner);
 
@@ -51,6 +54,7 @@ class ActionIndex : public Action {
 public:
 	virtual std::string ToString() const;
 	virtual SyntaxNode* Invoke(const std::vector<void*>& container);
+	virtual bool IsIdentity() const;
 };
 
 class ActionMake : public Action {
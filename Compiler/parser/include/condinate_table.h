@@ -0,0 +1,68 @@
+#pragma once
+#include <vector>
+
+#include "lr1.h"
+
+struct Environment;
+class FirstSetTable;
+
+// Per condinate data used by closures, computed once the first sets are known.
+// Condinates are numbered densely, those of one grammar are consecutive.
+class CondinateTable {
+public:
+	CondinateTable();
+
+public:
+	void Setup(const Environment* env, const FirstSetTable* firstSets);
+
+	// ids of the condinates of lhs are [GetFirstCondinate(lhs), GetLastCondinate(lhs)).
+	int GetFirstCondinate(const GrammarSymbol& lhs) const;
+	int GetLastCondinate(const GrammarSymbol& lhs) const;
+
+	int GetCpos(int id) const { return cposes_[id]; }
+
+	// A closure adds condinate id with dpos from 0 to GetClosureEnd(id),
+	// ie, the dot also skips the nullable prefix.
+	int GetClosureEnd(int id) const { return closureEnds_[id]; }
+
+	bool IsNullable(const GrammarSymbol& symbol) const;
+
+	// Whether symbols[dpos, end) of the condinate at cpos derive epsilon.
+	bool IsNullableSuffix(int cpos, int dpos) const;
+
+	// FIRST(symbols[dpos, end)) of the condinate at cpos, without epsilon.
+	const Forwards& GetFirstSet(int cpos, int dpos) const;
+
+	// Whether the item at (cpos, dpos) reduces, ie, the dot is at the end or the condinate is epsilon.
+	bool IsReduction(int cpos, int dpos) const;
+
+	// Sets answer to the LR(0) closure of items, from the closures of the nonterminals after the dots.
+	void CalculateClosure(const LR1Itemset& items, LR1Itemset& answer) const;
+
+private:
+	int GetPosition(int cpos, int dpos) const;
+	void CreateClosures();
+
+private:
+	// indexed by grammar index, the last one is the count of condinates.
+	std::vector<int> grammarCondinates_;
+
+	// indexed by symbol id, -1 if the symbol is no lhs.
+	std::vector<int> lhsGrammars_;
+	std::vector<bool> nullables_;
+
+	// indexed by condinate id.
+	std::vector<int> cposes_;
+	std::vector<int> closureEnds_;
+	std::vector<int> positions_;
+
+	// indexed by positions_[id] + dpos, 0 <= dpos <= symbols.size().
+	std::vector<bool> nullableSuffixes_;
+	std::vector<Forwards> firstSets_;
+
+	// id of symbols[dpos], -1 if the item reduces.
+	std::vector<int> symbolIDs_;
+
+	// indexed by symbol id, the sorted items added by a closure for lhs.
+	std::vector<std::vector<LR1Item> > closures_;
+};
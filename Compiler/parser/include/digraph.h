@@ -0,0 +1,26 @@
+#pragma once
+#include <vector>
+
+#include "lr1.h"
+
+// DeRemer & Pennello's digraph algorithm.
+// Afterwards sets[x] is the union of the initial sets[y] for every y reachable from x,
+// each strongly connected component is found by Tarjan's traversal and shares one set.
+class Digraph {
+public:
+	typedef std::vector<int> IntVector;
+	typedef std::vector<IntVector> Relation;
+	typedef std::vector<Forwards> ForwardsVector;
+
+public:
+	static void Solve(const Relation& relation, ForwardsVector& sets);
+
+	// Only solves the sets reachable from roots.
+	static void Solve(const Relation& relation, ForwardsVector& sets, const IntVector& roots);
+
+	// answer is the nodes reachable from roots, roots included.
+	static void Reach(const Relation& relation, const IntVector& roots, IntVector& answer);
+
+private:
+	static void Traverse(int x, const Relation& relation, ForwardsVector& sets, IntVector& stack, IntVector& depths);
+};
@@ -0,0 +1,63 @@
+#pragma once
+#include <vector>
+
+#include "lalr.h"
+
+// LALR(1) lookaheads computed by DeRemer & Pennello's relations:
+// Read = digraph(reads, DR), Follow = digraph(includes, Read),
+// LA(q, A -> w) = union of Follow(p, A) for (q, A -> w) lookback (p, A).
+//
+// In lazy mode, a state with a single reduction and no shift is adequate.
+// Its reduction gets every terminal as lookahead, ie, an LR(0) reduction,
+// and only the follows needed by the other reductions are computed.
+class DPLALR : public LALR {
+public:
+	DPLALR(bool lazy = false);
+	~DPLALR();
+
+protected:
+	virtual void CalculateForwards();
+
+private:
+	struct Transition {
+		int state;
+		GrammarSymbol symbol;
+	};
+
+	struct Lookback {
+		int state;
+		int cpos;
+		int dpos;
+		int transition;
+	};
+
+	typedef std::vector<int> IntVector;
+	typedef std::vector<IntVector> Relation;
+
+private:
+	void CreateTransitions();
+	void AddTransition(int state, const GrammarSymbol& symbol);
+
+	void CreateReads(ForwardsVector& follows);
+	void CreateIncludesAndLookbacks();
+	void WalkCondinate(int transition, int cpos, const SymbolVector& symbols, int dpos);
+
+	void ApplyLookbacks(const ForwardsVector& follows);
+
+	bool IsAdequate(int state) const;
+	void RemoveAdequateLookbacks();
+
+	int GetTransition(int state, const GrammarSymbol& symbol) const;
+
+private:
+	bool lazy_;
+
+	// indexed by state * symbolCount_ + symbol id.
+	IntVector transitionIndexes_;
+
+	std::vector<Transition> transitions_;
+
+	Relation reads_;
+	Relation includes_;
+	std::vector<Lookback> lookbacks_;
+};
@@ -32,6 +32,7 @@ public:
 public:
 	void SetLhs(const GrammarSymbol& symbol);
 	void AddCondinate(const std::string& action, const SymbolVector& symbols);
+	void RemoveCondinate(int index);
 
 	const GrammarSymbol& GetLhs() const;
 	const CondinateContainer& GetCondinates() const;
@@ -23,16 +23,17 @@ public:
 	virtual GrammarSymbolType SymbolType() const = 0;
 
 protected:
-	GrammarSymbolBase(const std::string& text) : text_(text) { }
+	GrammarSymbolBase(const std::string& text, int id) : text_(text), id_(id) { }
 	~GrammarSymbolBase() { }
 
 protected:
 	std::string text_;
+	int id_;
 };
 
 class TerminalSymbol : public GrammarSymbolBase {
 public:
-	TerminalSymbol(const std::string& text) : GrammarSymbolBase(text) { }
+	TerminalSymbol(const std::string& text, int id = -1) : GrammarSymbolBase(text, id) { }
 
 public:
 	virtual GrammarSymbolType SymbolType() const { return GrammarSymbolTerminal; }
@@ -40,7 +41,7 @@ public:
 
 class NonterminalSymbol : public GrammarSymbolBase {
 public:
-	NonterminalSymbol(const std::string& text) : GrammarSymbolBase(text) { }
+	NonterminalSymbol(const std::string& text) : GrammarSymbolBase(text, -1) { }
 
 public:
 	virtual GrammarSymbolType SymbolType() const { return GrammarSymbolNonterminal; }
@@ -70,13 +71,25 @@ public:
 public:
 	bool operator == (const GrammarSymbol& other) const { return ptr_ == other.ptr_; }
 	bool operator != (const GrammarSymbol& other) const { return ptr_ != other.ptr_; }
-	bool operator < (const GrammarSymbol& other) const { return ptr_ < other.ptr_; }
-	bool operator >(const GrammarSymbol& other) const { return ptr_ > other.ptr_; }
+	bool operator < (const GrammarSymbol& other) const { return Less(ptr_, other.ptr_); }
+	bool operator >(const GrammarSymbol& other) const { return Less(other.ptr_, ptr_); }
 
 public:
 	GrammarSymbolType SymbolType() const { return ptr_->SymbolType(); }
+
+	int GetID() const { return ptr_->id_; }
+	void SetID(int id) { ptr_->id_ = id; }
+
 	std::string ToString() const { return (ptr_ != nullptr) ? ptr_->ToString() : "null"; }
 
+private:
+	// ordered by id, symbols without one by address.
+	static bool Less(const GrammarSymbolBase* lhs, const GrammarSymbolBase* rhs) {
+		int lid = (lhs != nullptr) ? lhs->id_ : -1;
+		int rid = (rhs != nullptr) ? rhs->id_ : -1;
+		return (lid != rid) ? lid < rid : lhs < rhs;
+	}
+
 private:
 #pragma push_macro("new")
 #undef new
@@ -85,10 +98,17 @@ private:
 #pragma pop_macro("new")
 };
 
+// Native terminals are shared by every environment, so are their ids, [0, TerminalCount).
+// "Program" is not shared, each environment creates its own, see Environment::program.
 class NativeSymbols {
 public:
+	enum { TerminalCount = 6 };
+
 	static bool IsNative(const GrammarSymbol& symbol);
-	static void Copy(GrammarSymbolContainer& terminalSymbols, GrammarSymbolContainer& nonterminalSymbols);
+	static void Copy(GrammarSymbolContainer& terminalSymbols);
+
+	// appends the native terminals in the order of their ids.
+	static void CopyTerminals(SymbolVector& symbols);
 	
 public:
 	static GrammarSymbol null;
@@ -97,8 +117,9 @@ public:
 	static GrammarSymbol string;
 	static GrammarSymbol unknown;
 	static GrammarSymbol epsilon;
-	static GrammarSymbol program;
 	static GrammarSymbol identifier;
+
+	static const char* const programText;
 };
 
 typedef std::set<GrammarSymbol> GrammarSymbolSet;
@@ -109,6 +130,4 @@ public:
 };
 
 class FirstSetTable : public GrammarSymbolSetTable {
-public:
-	void GetFirstSet(GrammarSymbolSet& answer, SymbolVector::iterator first, SymbolVector::iterator last);
 };
@@ -1,4 +1,6 @@
 #pragma once
+#include <vector>
+
 #include "lr1.h"
 #include "lr_impl.h"
 #include "parser.h"
@@ -6,7 +8,7 @@
 struct Condinate;
 
 class LR0;
-class Grammar;
+class Grammar;
 class Ambiguities;
 
 class LALR : public LRImpl {
@@ -19,45 +21,85 @@ public:
 
 	virtual bool Parse(LRActionTable& actionTable, LRGotoTable& gotoTable);
 
-	virtual void Setup(Environment* env, FirstSetTable* firstSet);
+	virtual void Setup(Environment* env, FirstSetTable* firstSet, const GrammarSymbolSetTable* followSet, const CondinateTable* condinates);
+
+protected:
+	typedef std::vector<Forwards> ForwardsVector;
 
 protected:
+	// Fills forwards_ of the items in states_.
+	virtual void CalculateForwards();
 	virtual bool CreateLRParsingTable(LRGotoTable& gotoTable, LRActionTable& actionTable);
 
 	bool CreateGotoTable(LRGotoTable &gotoTable);
 	bool CreateActionTable(LRActionTable &actionTable);
-	bool InsertActionTable(LRActionTable &actionTable, const LR1Itemset& src, const GrammarSymbol& symbol, const LRAction& action);
+	bool InsertActionTable(LRActionTable &actionTable, int state, const GrammarSymbol& symbol, const LRAction& action);
+
+	void CreateItemIDs();
+	int GetGoto(int state, const GrammarSymbol& symbol) const;
+	int GetItemID(int state, const LR1Item& item) const;
+
+	// closure[i] are the forwards of itemset[i], itemset is the LR(0) closure of a state.
+	void CalculateClosure(const LR1Itemset& itemset, ForwardsVector& closure) const;
+
+	void InternForwards();
+	const Forwards& GetForwards(int id) const;
 
 private:
-	bool IsNullable(const GrammarSymbol& symbol);
+	// (state, index) of core items.
+	typedef std::vector<std::pair<int, int> > CoreVector;
 
-	void PropagateSymbols();
-	bool PropagateSymbolsOnePass();
-	bool PropagateFrom(const LR1Item& src);
+	typedef std::vector<std::pair<int, Forwards>, ArenaAllocator<std::pair<int, Forwards> > > ItemForwardsVector;
+	typedef std::vector<std::pair<int, int>, ArenaAllocator<std::pair<int, int> > > PropagationVector;
 
-	LR1Item FindItem(int cpos, int dpos, LR1Itemset& dict);
+	// spontaneous forwards and propagations found by one thread, as (item id, forwards) and (source, target).
+	struct ForwardsBatch {
+		ForwardsBatch(Arena* arena) : forwards(arena), propagations(arena) { }
 
-	void CalculateForwardsAndPropagations();
-	void AddForwardsAndPropagations(LR1Item& item, const LR1Itemset& itemset, LR1Itemset& dict, const GrammarSymbol& symbol);
+		ItemForwardsVector forwards;
+		PropagationVector propagations;
+	};
 
-	void CalculateLR1Itemset(LR1Itemset& answer, LR1Itemset& itemset);
-	bool CalculateLR1ItemsetOnePass(LR1Itemset& answer, LR1Itemset& itemset);
+private:
+	void PropagateSymbols();
 
-	bool CalculateLR1EdgeTarget(LR1Itemset& answer, const LR1Itemset& src, const GrammarSymbol& symbol);
+	void CalculateForwardsAndPropagations();
+	void CalculateBatch(const CoreVector& cores, int first, int last, ForwardsBatch* batch) const;
+	void AddForwardsAndPropagations(int state, int core, const LR1Itemset& itemset, const ForwardsVector& closure, ForwardsBatch& batch) const;
 
-	void AddLR1Items(LR1Itemset &answer, const GrammarSymbol& lhs, const LR1Item &current, LR1Itemset& itemset);
+	bool AddLR1Items(const LR1Itemset& itemset, const GrammarSymbol& lhs, const LR1Item& current, const Forwards& forwards, ForwardsVector& closure) const;
+	bool AddLR1Items(const LR1Itemset& itemset, const GrammarSymbol& lhs, const Forwards& firsts, ForwardsVector& closure) const;
 
-	bool ParseLRAction(LRActionTable & actionTable, const LR1Itemset& itemset, const LR1Item &item);
+	bool ParseLRAction(LRActionTable & actionTable, int state, const LR1Item &item, const Forwards& forwards);
 
-private:
+protected:
 	Environment* env_;
-	Ambiguities* ambiguities_;
 	FirstSetTable* firstSets_;
+	const GrammarSymbolSetTable* followSets_;
+	const CondinateTable* condinates_;
 
-	LR1Item tmp_;
+	int symbolCount_;
 	LR1EdgeTable edges_;
 
-	int coreItemsCount_;
+	// the kernel and the reductions of each state, see LR0.
+	LR1ItemsetContainer states_;
+
+	// items of state i have ids from itemIDs_[i], in itemset order.
+	std::vector<int> itemIDs_;
+
+	// indexed by item id, until the forwards are interned.
+	ForwardsVector forwards_;
+
+private:
+	Ambiguities* ambiguities_;
+
 	Propagations propagations_;
-	LR1ItemsetContainer itemsets_;
+
+	// batches and propagations, released once the forwards are interned.
+	Arena arena_;
+
+	ForwardsTable lookaheads_;
+
+	// indexed by item id, ids of the interned forwards.
+	std::vector<int> lookaheadIDs_;
 };
@@ -1,5 +1,7 @@
 #pragma once
 #include <string>
+#include <vector>
+#include "lr_impl.h"
 #include "grammar_symbol.h"
 
 class Syntaxer;
@@ -8,24 +10,51 @@ class TextScanner;
 
 struct Environment;
 
+// Bytes retained by a language, by component. Container overheads are estimated.
+struct MemoryReport {
+	// grammars and symbols.
+	size_t environment;
+
+	// the dense tables used while parsing.
+	size_t parsingTable;
+
+	// the tables of the generator, kept for ToString and saving. 0 once compacted.
+	size_t sparseTables;
+
+	std::string ToString() const;
+};
+
 class Language {
 public:
-	Language();
+	Language(LRImplType type = LRImplAuto, LRTableEncoding encoding = LRTableDense);
 	~Language();
 
 public:
-	void Setup(const char* productions, const char* fileName);
+	// if compact, only what parsing needs is kept once the parser is set up,
+	// ToString has no tables to print then.
+	void Setup(const char* productions, const char* fileName, bool compact = false);
+
+	// loads the parser Setup saved to fileName.
+	void Load(const char* fileName);
 
 public:
 	bool Parse(SyntaxTree* tree, const std::string& file);
 	std::string ToString() const;
 
+	void GetMemoryReport(MemoryReport& report) const;
+
 private:
 	void SaveSyntaxer(const char* fileName);
 	void LoadSyntaxer(const char* fileName);
 	void BuildSyntaxer(const char* productions);
 
 	bool SetupEnvironment(const char* productions);
+
+	// Removes the productions using unproductive symbols, then the grammars unreachable from Program.
+	// Returns whether anything was removed, the symbols must be numbered again then.
+	bool RemoveUselessSymbols();
+	void FindProductiveSymbols(std::vector<bool>& answer);
+	void FindReachableSymbols(std::vector<bool>& answer);
 	GrammarSymbol CreateSymbol(const std::string& text);
 	bool ParseProductions(const char* productions);
 	bool ParseProduction(TextScanner* textScanner, SymbolVector& symbols);
@@ -33,4 +62,7 @@ private:
 private:
 	Environment* env_;
 	Syntaxer* syntaxer_;
+
+	LRImplType type_;
+	LRTableEncoding encoding_;
 };
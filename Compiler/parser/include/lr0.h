@@ -1,10 +1,15 @@
 #pragma once
+#include <map>
+#include <vector>
+#include <unordered_map>
 
 #include "lr1.h"
+#include "arena.h"
 #include "grammar.h"
 #include "lr_impl.h"
 
 struct Environment;
+class CondinateTable;
 
 class LR0 {
 public:
@@ -13,22 +18,60 @@ public:
 
 public:
 	std::string ToString() const;
-	void Setup(Environment* env, FirstSetTable* firstSets);
-	bool CreateLR0Itemsets(LR1ItemsetContainer& itemsets, LR1EdgeTable& edges);
+	void Setup(Environment* env, const CondinateTable* condinates);
+	bool CreateLR0Itemsets(LR1ItemsetContainer& states, LR1EdgeTable& edges);
+
+public:
+	// sorted (cpos, dpos) pairs of the kernel items, allocated from the arena of a phase.
+	typedef std::vector<int, ArenaAllocator<int> > Kernel;
+
+	struct KernelHash {
+		size_t operator()(const Kernel& kernel) const;
+	};
 
 private:
-	void CalculateClosure(LR1Itemset& answer);
-	bool IsNullable(const GrammarSymbol& symbol);
-	void AddLR1Items(LR1Itemset& answer, const GrammarSymbol& lhs);
-	bool CalculateClosureOnePass(LR1Itemset& answer);
-	bool CalculateLR1EdgeTarget(LR1Itemset& answer, const LR1Itemset& src, const GrammarSymbol& symbol);
-	bool GetLR1EdgeTarget(LR1Itemset& answer, const LR1Itemset& src, const GrammarSymbol& symbol);
-	bool CreateLR1ItemsetsOnePass();
+	// state id of each kernel.
+	typedef std::unordered_map<Kernel, int, KernelHash> KernelContainer;
+
+	// state ids by the hash of their closures.
+	typedef std::unordered_multimap<size_t, int> ClosureContainer;
+
+	// (symbol id, kernel) of the successors of one state, ordered by symbol id.
+	typedef std::vector<std::pair<int, Kernel> > KernelVector;
+
+	// kernels of the successors by symbol id, while they are collected.
+	typedef std::map<int, Kernel, std::less<int>, ArenaAllocator<std::pair<const int, Kernel> > > KernelMap;
+
+	// states to expand, with their closures.
+	struct Frontier {
+		std::vector<int> states;
+		std::vector<LR1Itemset> closures;
+	};
+
+private:
+	void ExpandFrontier(Frontier& frontier);
+
+	// these run on worker threads, and only read shared data.
+	void CreateKernels(const Frontier& frontier, int first, int last, std::vector<KernelVector>* answer) const;
+	void CreateClosures(const std::vector<const Kernel*>& kernels, int first, int last, std::vector<LR1Itemset>* answer) const;
+
+	void CalculateClosure(const Kernel& kernel, LR1Itemset& answer) const;
+	int AddLR1Itemset(const Kernel& kernel, const LR1Itemset& closure, Frontier& frontier);
+
+	static size_t Hash(const LR1Itemset& itemset);
 
 private:
 	Environment* env_;
-	FirstSetTable* firstSets_;
+	const CondinateTable* condinates_;
 
 	LR1EdgeTable edges_;
-	LR1ItemsetContainer itemsets_;
+
+	// only the kernel and the reductions of each state are kept.
+	LR1ItemsetContainer states_;
+
+	KernelContainer kernels_;
+	ClosureContainer closures_;
+
+	// kernels of this phase, worker threads allocate from it too.
+	mutable Arena arena_;
 };
@@ -1,79 +1,95 @@
-#pragma once
-
-#include "matrix.h"
-#include "grammar_symbol.h"
-
-class GrammarContainer;
-
+#pragma once
+#include <map>
+
+#include "arena.h"
+#include "define.h"
+#include "grammar_symbol.h"
+
+struct Environment;
+
+// Set of lookahead symbols, stored as a bitset over terminal ids.
 class Forwards {
 public:
 	Forwards();
 
 public:
-	typedef std::set<GrammarSymbol> container_type;
-	typedef container_type::iterator iterator;
-	typedef container_type::const_iterator const_iterator;
+	// Yields symbol ids in ascending order.
+	class const_iterator {
+	public:
+		const_iterator(const Forwards* forwards, int id) : forwards_(forwards), id_(id) { }
+
+	public:
+		int operator * () const { return id_; }
+		const_iterator& operator ++ () { id_ = forwards_->Next(id_ + 1); return *this; }
+
+		bool operator == (const const_iterator& other) const { return id_ == other.id_; }
+		bool operator != (const const_iterator& other) const { return id_ != other.id_; }
+
+	private:
+		const Forwards* forwards_;
+		int id_;
+	};
 
 public:
 	bool operator < (const Forwards& other) const;
+	bool operator == (const Forwards& other) const;
 
 public:
-	int size() const { return cont_.size(); }
-	iterator begin() { return cont_.begin(); }
-	iterator end() { return cont_.end(); }
+	int size() const;
+	bool empty() const;
 
-	const_iterator begin() const { return cont_.begin(); }
-	const_iterator end() const { return cont_.end(); }
+	const_iterator begin() const { return const_iterator(this, Next(0)); }
+	const_iterator end() const { return const_iterator(this, MAX_TERMINAL_SYMBOLS); }
 
+	void clear();
 	void erase(const GrammarSymbol& symbol);
 	bool insert(const GrammarSymbol& symbol);
+	bool contains(const GrammarSymbol& symbol) const;
+
+	// Word-wise OR. Returns true if any symbol was added.
+	bool merge(const Forwards& other);
+
+	// Whether the two sets have any symbol in common.
+	bool intersects(const Forwards& other) const;
+
+	std::string ToString(const SymbolVector& symbols) const;
+
+private:
+	int Next(int id) const;
 
 private:
-	container_type cont_;
+	enum { WordBits = 32, WordCount = MAX_TERMINAL_SYMBOLS / WordBits };
+	unsigned words_[WordCount];
 };
 
+// A plain (cpos, dpos) pair. Lookaheads are not part of the item,
+// they are kept by the LR implementation and indexed by item id.
 class LR1Item {
-	struct Impl {
-		int cpos, dpos;
-		Forwards forwards;
-	};
-	IMPLEMENT_REFERENCE_COUNTABLE(LR1Item, Impl);
-	
 public:
-	LR1Item();
-	LR1Item(int cpos, int dpos);
-	LR1Item(int cpos, int dpos, const Forwards& forwards);
+	LR1Item() : cpos_(0), dpos_(0) { }
+	LR1Item(int cpos, int dpos) : cpos_(cpos), dpos_(dpos) { }
 
 	bool operator < (const LR1Item& other) const;
 	bool operator == (const LR1Item& other) const;
 
-	int GetCpos() const { return ptr_->cpos; }
-	void SetCpos(int pos) { ptr_->cpos = pos; }
-
-	int GetDpos() const { return ptr_->dpos; }
-	int SetDpos(int pos) { return ptr_->dpos = pos; }
+	int GetCpos() const { return cpos_; }
+	void SetCpos(int pos) { cpos_ = pos; }
 
-	Forwards& GetForwards() { return ptr_->forwards; }
-	const Forwards& GetForwards() const { return ptr_->forwards; }
+	int GetDpos() const { return dpos_; }
+	int SetDpos(int pos) { return dpos_ = pos; }
 
-	bool IsCore() const { return ptr_->dpos != 0 || ptr_->cpos == 0; }
+	bool IsCore() const { return dpos_ != 0 || cpos_ == 0; }
 
 	std::string ToRawString() const;
-	std::string ToString(const GrammarContainer& grammars) const;
+	std::string ToString(const Environment& env) const;
 
 private:
-#pragma push_macro("new")
-#undef new
-	// LR1Itemͨnew.
-	void* operator new(size_t);
-#pragma pop_macro("new")
+	int cpos_, dpos_;
 };
 
+// Items are kept in a sorted vector, so an item can also be addressed by its index.
 class LR1Itemset {
-	typedef class : public std::set <LR1Item> {
-		friend class LR1Itemset;
-		std::string name_;
-	} container_type;
+	typedef std::vector<LR1Item> container_type;
 
 	IMPLEMENT_REFERENCE_COUNTABLE(LR1Itemset, container_type);
 
@@ -81,18 +97,19 @@ public:
 	LR1Itemset();
 
 public:
-	typedef container_type::iterator iterator;
+	typedef container_type::const_iterator iterator;
 	typedef container_type::const_iterator const_iterator;
 
 public:
-	iterator begin() { return ptr_->begin(); }
 	const_iterator begin() const { return ptr_->begin(); }
-
-	iterator end() { return ptr_->end(); }
 	const_iterator end() const { return ptr_->end(); }
 
-	iterator find(const LR1Item& item) { return ptr_->find(item); }
-	const_iterator find(const LR1Item& item) const { return ptr_->find(item); }
+	const LR1Item& operator [] (int index) const { return (*ptr_)[index]; }
+
+	const_iterator find(const LR1Item& item) const;
+
+	// Returns the index of item, or -1 if it is not in this itemset.
+	int IndexOf(const LR1Item& item) const;
 
 	void clear() { ptr_->clear(); }
 	int size() const { return ptr_->size(); }
@@ -100,36 +117,67 @@ public:
 
 	bool insert(const LR1Item& item);
 
+	// items must be sorted and unique.
+	void assign(const std::vector<LR1Item>& items) { *ptr_ = items; }
+
 public:
 	bool operator < (const LR1Itemset& other) const;
 	bool operator == (const LR1Itemset& other) const;
 
 public:
-	const std::string& GetName() const;
-	void SetName(const std::string& name);
-
-	std::string ToString(const GrammarContainer& grammars) const;
+	std::string ToString(const Environment& env) const;
 
 private:
 #pragma push_macro("new")
 #undef new
-	// LR1Itemsetͨnew.
+// LR1Itemsetͨnew.
 	void* operator new(size_t);
 #pragma pop_macro("new")
 };
 
-class LR1ItemsetContainer : public std::set <LR1Itemset> {
+// Itemsets indexed by state id.
+class LR1ItemsetContainer : public std::vector <LR1Itemset> {
 public:
-	std::string ToString(const GrammarContainer& grammars) const;
+	std::string ToString(const Environment& env) const;
 };
 
-// TODO: or std::map<std::pair<std::string, LR1Item>, LR1Itemset> ?
-class Propagations : public std::map <LR1Item, LR1Itemset> {
+// Target item ids of each source item id, allocated from the arena of the forwards phase.
+class Propagations : public std::vector <std::vector<int, ArenaAllocator<int> > > {
+};
+
+// Interned forwards. Identical sets are stored once, so two sets are equal iff their ids are.
+class ForwardsTable {
 public:
-	std::string ToString(const GrammarContainer& grammars) const;
+	// Returns the id of forwards, it is added if it is new.
+	int insert(const Forwards& forwards);
+
+	const Forwards& operator [] (int id) const { return container_[id]; }
+
+	void clear();
+	int size() const { return (int)container_.size(); }
+
+private:
+	std::vector<Forwards> container_;
+	std::map<Forwards, int> ids_;
 };
 
-class LR1EdgeTable : public matrix <LR1Itemset, GrammarSymbol, LR1Itemset> {
+// Transitions of the automaton, indexed by (state id, symbol id).
+class LR1EdgeTable {
 public:
-	std::string ToString(const GrammarContainer& grammars) const;
+	LR1EdgeTable();
+
+public:
+	// Removes all transitions, symbol ids are in [0, symbolCount).
+	void clear(int symbolCount);
+
+	void insert(int state, int symbol, int target);
+
+	// Returns the target state, or -1 if there is no transition.
+	int get(int state, int symbol) const;
+
+	std::string ToString(const Environment& env) const;
+
+private:
+	int symbolCount_;
+	std::vector<int> container_;
 };
@@ -6,6 +6,8 @@ struct Environment;
 class LRGotoTable;
 class LRActionTable;
 class FirstSetTable;
+class GrammarSymbolSetTable;
+class CondinateTable;
 class GrammarContainer;
 
 enum LRActionType {
@@ -13,6 +15,34 @@ enum LRActionType {
 	LRActionShift,
 	LRActionReduce,
 	LRActionAccept,
+
+	// shift, then reduce condinate parameter at once, the state shifted to does nothing else.
+	LRActionShiftReduce,
+};
+
+enum LRImplType {
+	LRImplLALR,
+	LRImplDPLALR,
+
+	// DPLALR computing lookaheads only for the reductions of inadequate states.
+	LRImplLazyDPLALR,
+
+	// minimal LR(1) by Pager's weak compatibility.
+	LRImplPager,
+
+	// SLR(1), fails if the tables have conflicts.
+	LRImplSLR,
+
+	// SLR(1) if the tables have no conflict, otherwise DPLALR on the same LR(0) automaton.
+	LRImplAuto,
+};
+
+enum LRTableEncoding {
+	// arrays of states x symbols.
+	LRTableDense,
+
+	// action rows and goto columns share one array by row displacement, as yacc does.
+	LRTablePacked,
 };
 
 struct LRAction {
@@ -33,5 +63,5 @@ public:
 	virtual std::string ToString() const = 0;
 
 	virtual bool Parse(LRActionTable& actionTable, LRGotoTable& gotoTable) = 0;
-	virtual void Setup(Environment* env, FirstSetTable* firstSet) = 0;
+	virtual void Setup(Environment* env, FirstSetTable* firstSet, const GrammarSymbolSetTable* followSet, const CondinateTable* condinates) = 0;
 };
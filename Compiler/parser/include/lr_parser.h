@@ -1,12 +1,13 @@
 #pragma once
 #include "parser.h"
+#include "lr_impl.h"
 
 class LRImpl;
 class LRTable;
 
 class LRParser : public Parser {
 public:
-	LRParser();
+	LRParser(LRImplType type = LRImplAuto, LRTableEncoding encoding = LRTableDense);
 	~LRParser();
 
 public:
@@ -20,6 +21,8 @@ private:
 	void CreateFirstSets();
 	void CreateFollowSets();
 
+	bool CreateLRTable(Environment* env);
+
 private:
 	LRImpl* impl_;
 	LRTable* lrTable_;
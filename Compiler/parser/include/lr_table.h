@@ -1,4 +1,7 @@
 #pragma once
+#include <set>
+#include <vector>
+
 #include "matrix.h"
 #include "lr_impl.h"
 
@@ -22,12 +25,83 @@ public:
 	friend class LRParser;
 
 public:
-	int GetGoto(int current, const GrammarSymbol& symbol);
-	LRAction GetAction(int current, const GrammarSymbol& symbol);
+	// Folds the most frequent reduction of each state into its default action,
+	// the entries of actionTable_ equal to it are removed.
+	void CreateDefaultReductions();
+
+	// Gotos to a state whose only action is a reduction A : B with $$ = $1 go to the goto on A instead,
+	// so a chain of such reductions is skipped. Must follow CreateDefaultReductions.
+	void EliminateUnitReductions(const GrammarContainer& grammars);
+
+	// Shifts to a state whose only action is its default reduction become LRActionShiftReduce,
+	// if that reduction pops the state shifted to. Must follow CreateDefaultReductions.
+	void CreateShiftReductions(const GrammarContainer& grammars);
+
+	// LRTableDense by default, must be set before Freeze.
+	void SetEncoding(LRTableEncoding encoding);
+
+	// Build the tables used at parse time from gotoTable_, actionTable_ and the default reductions.
+	void Freeze(int terminalCount, int nonterminalCount);
+
+	// Drops gotoTable_ and actionTable_ once frozen, they are only used by ToString and saving.
+	void Compact();
+
+	// Bytes of the tables used at parse time, and of gotoTable_ and actionTable_.
+	size_t GetRetainedBytes() const;
+	size_t GetSparseBytes() const;
+
+	// Columns are the symbol ids of the environment the table was built for,
+	// symbol must be one of its symbols, see Environment::NumberSymbols.
+	int GetGoto(int current, const GrammarSymbol& symbol) const;
+	LRAction GetAction(int current, const GrammarSymbol& symbol) const;
+
+	// The condinate reduced in state current whatever the lookahead is, -1 if the action depends on it.
+	int GetLR0Reduction(int current) const;
 	
 	std::string ToString(const GrammarContainer& grammars) const;
 
+private:
+	int CountStates() const;
+
+	// the default reduction of the states without any other action, else -1.
+	void FindLR0Reductions(std::vector<int>& answer) const;
+
+	void CreateDenseTables();
+	void CreatePackedTables();
+
+	// (index, entry) pairs of an action row or a goto column, sorted by index.
+	typedef std::vector<std::pair<int, LRAction> > PackedVector;
+
+	// Returns the base of vector, no two vectors with entries share one.
+	int PackVector(const PackedVector& vector, std::set<int>& bases, int& firstFree);
+
 private:
 	LRGotoTable gotoTable_;
 	LRActionTable actionTable_;
+
+	LRTableEncoding encoding_;
+
+	int stateCount_;
+	int terminalCount_;
+	int nonterminalCount_;
+
+	// Row per state, indexed by symbol id.
+	std::vector<int> gotos_;
+	std::vector<LRAction> actions_;
+
+	// Indexed by state, the default reduction, -1 if there is none.
+	std::vector<int> defaults_;
+
+	// Indexed by state, the default reduction of the states without any other action, else -1.
+	std::vector<int> lr0Reductions_;
+
+	// LRTablePacked: action rows and goto columns share next_ and check_.
+	// (state, terminal) is next_[actionBases_[state] + terminal] if check_ there is the terminal, else the default reduction.
+	// (state, nonterminal) is next_[gotoBases_[nonterminal] + state] if check_ there is the state, else defaultGotos_[nonterminal].
+	// Nonterminals are indexed by id - terminalCount_, a goto entry keeps its target in parameter.
+	std::vector<int> actionBases_;
+	std::vector<int> gotoBases_;
+	std::vector<int> defaultGotos_;
+	std::vector<LRAction> next_;
+	std::vector<int> check_;
 };
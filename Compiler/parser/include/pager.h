@@ -0,0 +1,55 @@
+#pragma once
+#include <queue>
+#include <vector>
+#include <unordered_map>
+
+#include "lr0.h"
+#include "lalr.h"
+#include "arena.h"
+
+// Minimal LR(1) by Pager's weak compatibility.
+// LR(1) states with the same kernel are merged, unless merging could add
+// a reduce/reduce conflict that canonical LR(1) does not have. The table is
+// near LALR(1) sized, without the conflicts LALR(1) merging introduces.
+class Pager : public LALR {
+public:
+	Pager();
+	~Pager();
+
+public:
+	virtual bool Parse(LRActionTable& actionTable, LRGotoTable& gotoTable);
+
+private:
+	// forwards[i] are the forwards of the i-th kernel item.
+	struct State {
+		LR0::Kernel kernel;
+		ForwardsVector forwards;
+	};
+
+	// ids of the states with the same kernel.
+	typedef std::unordered_map<LR0::Kernel, std::vector<int>, LR0::KernelHash> KernelContainer;
+
+private:
+	void CreateLR1States();
+	void ExpandState(int state);
+	int AddState(const LR0::Kernel& kernel, const ForwardsVector& forwards);
+	void Enqueue(int state);
+
+	bool IsWeaklyCompatible(const ForwardsVector& x, const ForwardsVector& y) const;
+	void CalculateLR1Closure(int state, LR1Itemset& itemset, ForwardsVector& closure) const;
+
+	// states_, edges_ and forwards_ from the states reachable from the start state.
+	void CopyReachableStates();
+
+private:
+	std::vector<State> lr1States_;
+	LR1EdgeTable lr1Edges_;
+	KernelContainer kernels_;
+
+	// states whose forwards have changed since they were expanded.
+	std::queue<int> queue_;
+	std::vector<bool> queued_;
+
+	// kernels of the LR(1) states, released with them.
+	Arena arena_;
+};
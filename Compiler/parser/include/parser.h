@@ -1,5 +1,6 @@
 #pragma once
 #include "grammar.h"
+#include "condinate_table.h"
 
 class Syntaxer;
 class SyntaxTree;
@@ -13,9 +14,31 @@ struct Environment {
 	GrammarSymbolContainer terminalSymbols;
 	GrammarSymbolContainer nonterminalSymbols;
 
+	// Indexed by symbol id.
+	SymbolVector symbols;
+
+	// The start symbol, owned by this environment since its id depends on the grammar.
+	GrammarSymbol program;
+
 	bool Load(std::ifstream& file);
 	bool Save(std::ofstream& file);
 
+	// Put the native symbols into the containers, and create program.
+	void AddNativeSymbols();
+
+	// Assign dense ids to symbols: terminals in [0, T), with the native ones
+	// first (see NativeSymbols), and non-terminals in [T, T + N).
+	// Only the symbols of this environment are written, the native terminals are shared.
+	// Symbols are ordered by id, so this must be done before they are put into any set.
+	void NumberSymbols();
+
+	// Number of ids used by terminals, including NativeSymbols::unknown.
+	int TerminalCount() const;
+	int NonterminalCount() const;
+
+	// Estimated bytes of the grammars and of the symbol containers.
+	size_t GetRetainedBytes() const;
+
 	~Environment();
 };
 
@@ -37,7 +60,6 @@ protected:
 protected:
 	Grammar* FindGrammar(const GrammarSymbol& lhs, int* index = nullptr);
 	GrammarSymbol CreateSymbol(const std::string& text);
-	bool MergeNonEpsilonElements(GrammarSymbolSet& dest, const GrammarSymbolSet& src);
 
 	void CreateFirstSets();
 	void CreateFollowSets();
@@ -49,7 +71,10 @@ protected:
 	FirstSetTable firstSetContainer_;
 	GrammarSymbolSetTable followSetContainer_;
 
+	// FIRST of condinate suffixes, computed once from firstSetContainer_.
+	CondinateTable condinateTable_;
+
 private:
-	bool CreateFirstSetsOnePass();
-	bool CreateFollowSetsOnePass();
+	void CreateNullables(std::vector<bool>& nullables);
+	void CopyForwards(GrammarSymbolSet& answer, const Forwards& forwards);
 };
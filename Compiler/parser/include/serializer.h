@@ -1,4 +1,5 @@
 #pragma once
+#include <vector>
 #include <fstream>
 
 class LRTable;
@@ -39,7 +40,9 @@ private:
 private:
 	static bool WriteInteger(std::ofstream& file, int x);
 	static bool WriteString(std::ofstream& file, const std::string& str);
+	static bool WriteIntegers(std::ofstream& file, const std::vector<int>& integers);
 
 	static bool ReadInteger(std::ifstream& file, int& integer);
 	static bool ReadString(std::ifstream& file, std::string& str);
+	static bool ReadIntegers(std::ifstream& file, std::vector<int>& integers);
 };
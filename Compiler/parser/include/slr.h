@@ -0,0 +1,22 @@
+#pragma once
+#include "dp_lalr.h"
+
+// SLR(1): the lookaheads of a reduction A : alpha. are FOLLOW(A).
+// If the tables would have conflicts, Parse fails without filling them,
+// or with fallback, computes the LALR(1) lookaheads as DPLALR does,
+// keeping the LR(0) automaton already built.
+class SLR : public DPLALR {
+public:
+	SLR(bool fallback = false);
+	~SLR();
+
+protected:
+	virtual void CalculateForwards();
+	virtual bool CreateLRParsingTable(LRGotoTable& gotoTable, LRActionTable& actionTable);
+
+private:
+	bool HasConflict(int state) const;
+
+private:
+	bool fallback_;
+};
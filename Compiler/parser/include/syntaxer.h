@@ -35,12 +35,17 @@ public:
 	void Setup(const SyntaxerSetupParameter& p);
 	bool ParseSyntax(SyntaxTree* tree, FileScanner* fileScanner);
 
+	// Keeps only what parsing needs, see LRTable::Compact.
+	void Compact();
+	const LRTable& GetLRTable() const { return p_.lrTable; }
+
 public:
 	std::string ToString() const;
 
 private:
 	int Reduce(int cpos);
 	void Shift(int state, void* addr, const GrammarSymbol& symbol);
+	int ShiftReduce(int cpos, void* addr, const GrammarSymbol& symbol);
 	bool Error(const GrammarSymbol& symbol, const TokenPosition& position);
 
 	bool CreateSyntaxTree(SyntaxNode*& root, FileScanner* fileScanner);
@@ -26,6 +26,10 @@ bool Action::ParseParameters(TextScanner& scanner, Argument& argument) {
 	return true;
 }
 
+bool Action::IsIdentity() const {
+	return false;
+}
+
 bool Action::SplitParameters(int* parameters, int& count, TextScanner& scanner) {
 	char token[MAX_TOKEN_CHARACTERS];
 	ScannerTokenType tokenType = ScannerTokenEndOfFile, expectedTokenType = ScannerTokenIdentifier;
@@ -105,6 +109,10 @@ SyntaxNode* ActionIndex::Invoke(const std::vector<void*>& container) {
 	return (SyntaxNode*)container[container.size() - argument_.parameters.front()];
 }
 
+bool ActionIndex::IsIdentity() const {
+	return argument_.parameters.front() == 1;
+}
+
 std::string ActionMake::ToString() const {
 	std::ostringstream oss;
 	
@@ -0,0 +1,182 @@
+#include <algorithm>
+
+#include "debug.h"
+#include "parser.h"
+#include "grammar.h"
+#include "condinate_table.h"
+
+CondinateTable::CondinateTable() {
+}
+
+void CondinateTable::Setup(const Environment* env, const FirstSetTable* firstSets) {
+	nullables_.assign(env->symbols.size(), false);
+	for (int id = 0; id < (int)env->symbols.size(); ++id) {
+		FirstSetTable::const_iterator pos = firstSets->find(env->symbols[id]);
+		if (pos != firstSets->end()) {
+			nullables_[id] = pos->second.find(NativeSymbols::epsilon) != pos->second.end();
+		}
+	}
+
+	grammarCondinates_.clear();
+	lhsGrammars_.assign(env->symbols.size(), -1);
+
+	cposes_.clear();
+	closureEnds_.clear();
+	positions_.clear();
+	nullableSuffixes_.clear();
+	firstSets_.clear();
+	symbolIDs_.clear();
+
+	int gi = 0;
+	for (GrammarContainer::const_iterator ite = env->grammars.begin(); ite != env->grammars.end(); ++ite, ++gi) {
+		grammarCondinates_.push_back((int)cposes_.size());
+		lhsGrammars_[(*ite)->GetLhs().GetID()] = gi;
+
+		int ci = 0;
+		const CondinateContainer& conds = (*ite)->GetCondinates();
+		for (CondinateContainer::const_iterator ite2 = conds.begin(); ite2 != conds.end(); ++ite2, ++ci) {
+			const SymbolVector& symbols = (*ite2)->symbols;
+			cposes_.push_back(Utility::MakeDword(ci, gi));
+
+			int end = 0;
+			for (; end < (int)symbols.size(); ++end) {
+				if (symbols[end] == NativeSymbols::epsilon || !IsNullable(symbols[end])) {
+					break;
+				}
+			}
+
+			closureEnds_.push_back(end);
+
+			int first = (int)firstSets_.size();
+			positions_.push_back(first);
+
+			nullableSuffixes_.resize(first + symbols.size() + 1, true);
+			firstSets_.resize(first + symbols.size() + 1);
+
+			for (int i = 0; i < (int)symbols.size(); ++i) {
+				symbolIDs_.push_back(symbols[i].GetID());
+			}
+
+			symbolIDs_.push_back(-1);
+			if (symbols.front() == NativeSymbols::epsilon) {
+				symbolIDs_[first] = -1;
+			}
+
+			// from the end, FIRST(symbols[i, end)) = FIRST(symbols[i]) + FIRST(symbols[i + 1, end)) if symbols[i] is nullable.
+			for (int i = (int)symbols.size() - 1; i >= 0; --i) {
+				const GrammarSymbol& symbol = symbols[i];
+				Forwards& answer = firstSets_[first + i];
+
+				if (symbol.SymbolType() == GrammarSymbolTerminal) {
+					if (symbol != NativeSymbols::epsilon) {
+						answer.insert(symbol);
+					}
+				}
+				else {
+					const GrammarSymbolSet& firstSet = firstSets->at(symbol);
+					for (GrammarSymbolSet::const_iterator fi = firstSet.begin(); fi != firstSet.end(); ++fi) {
+						if (*fi != NativeSymbols::epsilon) {
+							answer.insert(*fi);
+						}
+					}
+				}
+
+				bool nullable = IsNullable(symbol);
+				if (nullable) {
+					answer.merge(firstSets_[first + i + 1]);
+				}
+
+				nullableSuffixes_[first + i] = nullable && nullableSuffixes_[first + i + 1];
+			}
+		}
+	}
+
+	grammarCondinates_.push_back((int)cposes_.size());
+
+	CreateClosures();
+}
+
+void CondinateTable::CreateClosures() {
+	closures_.assign(lhsGrammars_.size(), std::vector<LR1Item>());
+	for (int lhs = 0; lhs < (int)lhsGrammars_.size(); ++lhs) {
+		if (lhsGrammars_[lhs] < 0) {
+			continue;
+		}
+
+		std::vector<LR1Item>& answer = closures_[lhs];
+		std::vector<bool> visited(lhsGrammars_.size(), false);
+		std::vector<int> stack(1, lhs);
+		visited[lhs] = true;
+
+		for (; !stack.empty();) {
+			int gi = lhsGrammars_[stack.back()];
+			stack.pop_back();
+
+			for (int id = grammarCondinates_[gi]; id < grammarCondinates_[gi + 1]; ++id) {
+				for (int dpos = 0; dpos <= closureEnds_[id]; ++dpos) {
+					answer.push_back(LR1Item(cposes_[id], dpos));
+
+					int symbol = symbolIDs_[positions_[id] + dpos];
+					if (symbol >= 0 && lhsGrammars_[symbol] >= 0 && !visited[symbol]) {
+						visited[symbol] = true;
+						stack.push_back(symbol);
+					}
+				}
+			}
+		}
+
+		std::sort(answer.begin(), answer.end());
+	}
+}
+
+int CondinateTable::GetFirstCondinate(const GrammarSymbol& lhs) const {
+	int gi = lhsGrammars_[lhs.GetID()];
+	Assert(gi >= 0, "can not find grammar with lhs = " + lhs.ToString() + ".");
+	return grammarCondinates_[gi];
+}
+
+int CondinateTable::GetLastCondinate(const GrammarSymbol& lhs) const {
+	int gi = lhsGrammars_[lhs.GetID()];
+	Assert(gi >= 0, "can not find grammar with lhs = " + lhs.ToString() + ".");
+	return grammarCondinates_[gi + 1];
+}
+
+bool CondinateTable::IsNullable(const GrammarSymbol& symbol) const {
+	return nullables_[symbol.GetID()];
+}
+
+bool CondinateTable::IsNullableSuffix(int cpos, int dpos) const {
+	return nullableSuffixes_[GetPosition(cpos, dpos)];
+}
+
+const Forwards& CondinateTable::GetFirstSet(int cpos, int dpos) const {
+	return firstSets_[GetPosition(cpos, dpos)];
+}
+
+bool CondinateTable::IsReduction(int cpos, int dpos) const {
+	return symbolIDs_[GetPosition(cpos, dpos)] < 0;
+}
+
+void CondinateTable::CalculateClosure(const LR1Itemset& items, LR1Itemset& answer) const {
+	std::vector<LR1Item> container(items.begin(), items.end());
+	std::vector<bool> visited(closures_.size(), false);
+
+	// the closure of a nonterminal is closed already, so one pass is enough.
+	for (LR1Itemset::const_iterator ite = items.begin(); ite != items.end(); ++ite) {
+		int symbol = symbolIDs_[GetPosition(ite->GetCpos(), ite->GetDpos())];
+		if (symbol >= 0 && !visited[symbol]) {
+			visited[symbol] = true;
+			container.insert(container.end(), closures_[symbol].begin(), closures_[symbol].end());
+		}
+	}
+
+	std::sort(container.begin(), container.end());
+	container.erase(std::unique(container.begin(), container.end()), container.end());
+
+	answer.assign(container);
+}
+
+int CondinateTable::GetPosition(int cpos, int dpos) const {
+	int id = grammarCondinates_[Utility::Highword(cpos)] + Utility::Loword(cpos);
+	return positions_[id] + dpos;
+}
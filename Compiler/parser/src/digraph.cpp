@@ -0,0 +1,76 @@
+#include <climits>
+#include <algorithm>
+
+#include "digraph.h"
+
+void Digraph::Solve(const Relation& relation, ForwardsVector& sets) {
+	IntVector stack;
+	IntVector depths(relation.size(), 0);
+	for (int x = 0; x < (int)relation.size(); ++x) {
+		if (depths[x] == 0) {
+			Traverse(x, relation, sets, stack, depths);
+		}
+	}
+}
+
+void Digraph::Solve(const Relation& relation, ForwardsVector& sets, const IntVector& roots) {
+	IntVector stack;
+	IntVector depths(relation.size(), 0);
+	for (IntVector::const_iterator ite = roots.begin(); ite != roots.end(); ++ite) {
+		if (depths[*ite] == 0) {
+			Traverse(*ite, relation, sets, stack, depths);
+		}
+	}
+}
+
+void Digraph::Reach(const Relation& relation, const IntVector& roots, IntVector& answer) {
+	std::vector<bool> visited(relation.size(), false);
+	IntVector stack;
+
+	answer.clear();
+	for (IntVector::const_iterator ite = roots.begin(); ite != roots.end(); ++ite) {
+		if (!visited[*ite]) {
+			visited[*ite] = true;
+			stack.push_back(*ite);
+		}
+	}
+
+	for (; !stack.empty();) {
+		int x = stack.back();
+		stack.pop_back();
+		answer.push_back(x);
+
+		for (IntVector::const_iterator ite = relation[x].begin(); ite != relation[x].end(); ++ite) {
+			if (!visited[*ite]) {
+				visited[*ite] = true;
+				stack.push_back(*ite);
+			}
+		}
+	}
+}
+
+void Digraph::Traverse(int x, const Relation& relation, ForwardsVector& sets, IntVector& stack, IntVector& depths) {
+	stack.push_back(x);
+	int depth = (int)stack.size();
+	depths[x] = depth;
+
+	for (IntVector::const_iterator ite = relation[x].begin(); ite != relation[x].end(); ++ite) {
+		int y = *ite;
+		if (depths[y] == 0) {
+			Traverse(y, relation, sets, stack, depths);
+		}
+
+		depths[x] = std::min(depths[x], depths[y]);
+		sets[x].merge(sets[y]);
+	}
+
+	// x is the root of a strongly connected component.
+	if (depths[x] == depth) {
+		for (int top = -1; top != x;) {
+			top = stack.back();
+			stack.pop_back();
+			depths[top] = INT_MAX;
+			sets[top] = sets[x];
+		}
+	}
+}
@@ -0,0 +1,196 @@
+#include "debug.h"
+#include "dp_lalr.h"
+#include "digraph.h"
+#include "grammar.h"
+
+DPLALR::DPLALR(bool lazy) : lazy_(lazy) {
+}
+
+DPLALR::~DPLALR() {
+}
+
+void DPLALR::CalculateForwards() {
+	Debug::StartSample("create transitions");
+	CreateTransitions();
+	Debug::EndSample();
+
+	ForwardsVector follows;
+
+	Debug::StartSample("create relations");
+	CreateReads(follows);
+	CreateIncludesAndLookbacks();
+	Debug::EndSample();
+
+	if (lazy_) {
+		RemoveAdequateLookbacks();
+	}
+
+	// only the follows reachable from the lookbacks are used.
+	IntVector roots, reachables;
+	for (std::vector<Lookback>::const_iterator ite = lookbacks_.begin(); ite != lookbacks_.end(); ++ite) {
+		roots.push_back(ite->transition);
+	}
+
+	Digraph::Reach(includes_, roots, reachables);
+
+	Debug::StartSample("calculate reads");
+	Digraph::Solve(reads_, follows, reachables);
+	Debug::EndSample();
+
+	Debug::StartSample("calculate follows");
+	Digraph::Solve(includes_, follows, roots);
+	Debug::EndSample();
+
+	ApplyLookbacks(follows);
+}
+
+void DPLALR::CreateTransitions() {
+	transitionIndexes_.assign(states_.size() * symbolCount_, -1);
+
+	transitions_.clear();
+
+	// program has no goto, its follow is {$}.
+	AddTransition(0, env_->program);
+
+	for (int i = 0; i < (int)states_.size(); ++i) {
+		for (int id = env_->TerminalCount(); id < symbolCount_; ++id) {
+			if (edges_.get(i, id) >= 0) {
+				AddTransition(i, env_->symbols[id]);
+			}
+		}
+	}
+
+	reads_.assign(transitions_.size(), IntVector());
+	includes_.assign(transitions_.size(), IntVector());
+	lookbacks_.clear();
+}
+
+void DPLALR::AddTransition(int state, const GrammarSymbol& symbol) {
+	transitionIndexes_[state * symbolCount_ + symbol.GetID()] = (int)transitions_.size();
+	Transition transition = { state, symbol };
+	transitions_.push_back(transition);
+}
+
+void DPLALR::CreateReads(ForwardsVector& follows) {
+	follows.assign(transitions_.size(), Forwards());
+	follows[0].insert(NativeSymbols::zero);
+
+	for (int x = 1; x < (int)transitions_.size(); ++x) {
+		int r = GetGoto(transitions_[x].state, transitions_[x].symbol);
+		for (int id = 0; id < symbolCount_; ++id) {
+			if (edges_.get(r, id) < 0) {
+				continue;
+			}
+
+			const GrammarSymbol& symbol = env_->symbols[id];
+			if (symbol.SymbolType() == GrammarSymbolTerminal) {
+				follows[x].insert(symbol);
+			}
+			else if (condinates_->IsNullable(symbol)) {
+				reads_[x].push_back(GetTransition(r, symbol));
+			}
+		}
+	}
+}
+
+void DPLALR::CreateIncludesAndLookbacks() {
+	for (int x = 0; x < (int)transitions_.size(); ++x) {
+		const GrammarSymbol& lhs = transitions_[x].symbol;
+		int last = condinates_->GetLastCondinate(lhs);
+		for (int id = condinates_->GetFirstCondinate(lhs); id < last; ++id) {
+			int cpos = condinates_->GetCpos(id);
+			const SymbolVector& symbols = env_->grammars.GetTargetCondinate(cpos, nullptr)->symbols;
+
+			if (symbols.front() == NativeSymbols::epsilon) {
+				Lookback lookback = { transitions_[x].state, cpos, 0, x };
+				lookbacks_.push_back(lookback);
+				continue;
+			}
+
+			// the closure also starts a condinate after each nullable prefix.
+			// but program is not in a closure, the accept action is after its whole condinate only.
+			int end = (x == 0) ? 0 : condinates_->GetClosureEnd(id);
+			for (int dpos = 0; dpos <= end; ++dpos) {
+				WalkCondinate(x, cpos, symbols, dpos);
+			}
+		}
+	}
+}
+
+void DPLALR::WalkCondinate(int transition, int cpos, const SymbolVector& symbols, int dpos) {
+	int state = transitions_[transition].state;
+	for (int i = dpos; i < (int)symbols.size(); ++i) {
+		const GrammarSymbol& symbol = symbols[i];
+		if (symbol.SymbolType() == GrammarSymbolNonterminal && condinates_->IsNullableSuffix(cpos, i + 1)) {
+			includes_[GetTransition(state, symbol)].push_back(transition);
+		}
+
+		state = GetGoto(state, symbol);
+	}
+
+	Lookback lookback = { state, cpos, (int)symbols.size(), transition };
+	lookbacks_.push_back(lookback);
+}
+
+void DPLALR::ApplyLookbacks(const ForwardsVector& follows) {
+	for (std::vector<Lookback>::const_iterator ite = lookbacks_.begin(); ite != lookbacks_.end(); ++ite) {
+		int id = GetItemID(ite->state, LR1Item(ite->cpos, ite->dpos));
+		forwards_[id].merge(follows[ite->transition]);
+	}
+}
+
+bool DPLALR::IsAdequate(int state) const {
+	int reductions = 0;
+	const LR1Itemset& itemset = states_[state];
+	for (LR1Itemset::const_iterator ite = itemset.begin(); ite != itemset.end(); ++ite) {
+		if (condinates_->IsReduction(ite->GetCpos(), ite->GetDpos())) {
+			++reductions;
+		}
+	}
+
+	if (reductions != 1) {
+		return reductions == 0;
+	}
+
+	for (int id = 0; id < env_->TerminalCount(); ++id) {
+		if (edges_.get(state, id) >= 0) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void DPLALR::RemoveAdequateLookbacks() {
+	Forwards terminals;
+	for (int id = 0; id < env_->TerminalCount(); ++id) {
+		const GrammarSymbol& symbol = env_->symbols[id];
+		if (symbol != NativeSymbols::epsilon && symbol != NativeSymbols::unknown) {
+			terminals.insert(symbol);
+		}
+	}
+
+	std::vector<bool> adequates(states_.size());
+	for (int i = 0; i < (int)states_.size(); ++i) {
+		adequates[i] = IsAdequate(i);
+	}
+
+	// the follow of program is {$} already, it stays for the accept action.
+	std::vector<Lookback> lookbacks;
+	for (std::vector<Lookback>::const_iterator ite = lookbacks_.begin(); ite != lookbacks_.end(); ++ite) {
+		if (!adequates[ite->state] || ite->transition == 0) {
+			lookbacks.push_back(*ite);
+		}
+		else {
+			forwards_[GetItemID(ite->state, LR1Item(ite->cpos, ite->dpos))] = terminals;
+		}
+	}
+
+	lookbacks_.swap(lookbacks);
+}
+
+int DPLALR::GetTransition(int state, const GrammarSymbol& symbol) const {
+	int answer = transitionIndexes_[state * symbolCount_ + symbol.GetID()];
+	Assert(answer >= 0, "can not find transition.");
+	return answer;
+}
@@ -76,6 +76,11 @@ void Grammar::AddCondinate(const std::string& action, const SymbolVector& symbol
 	condinates_.push_back(ptr);
 }
 
+void Grammar::RemoveCondinate(int index) {
+	delete condinates_[index];
+	condinates_.erase(condinates_.begin() + index);
+}
+
 const CondinateContainer& Grammar::GetCondinates() const {
 	return condinates_;
 }
@@ -5,13 +5,14 @@
 #include "grammar_symbol.h"
 
 GrammarSymbol NativeSymbols::null = nullptr;
-GrammarSymbol NativeSymbols::zero = new TerminalSymbol("zero");
-GrammarSymbol NativeSymbols::unknown = new TerminalSymbol("#");
-GrammarSymbol NativeSymbols::number = new TerminalSymbol("number");
-GrammarSymbol NativeSymbols::string = new TerminalSymbol("string");
-GrammarSymbol NativeSymbols::epsilon = new TerminalSymbol("epsilon");
-GrammarSymbol NativeSymbols::identifier = new TerminalSymbol("identifier");
-GrammarSymbol NativeSymbols::program = new NonterminalSymbol("Program");
+GrammarSymbol NativeSymbols::zero = new TerminalSymbol("zero", 0);
+GrammarSymbol NativeSymbols::unknown = new TerminalSymbol("#", 1);
+GrammarSymbol NativeSymbols::number = new TerminalSymbol("number", 2);
+GrammarSymbol NativeSymbols::string = new TerminalSymbol("string", 3);
+GrammarSymbol NativeSymbols::epsilon = new TerminalSymbol("epsilon", 4);
+GrammarSymbol NativeSymbols::identifier = new TerminalSymbol("identifier", 5);
+
+const char* const NativeSymbols::programText = "Program";
 
 std::string GrammarSymbolContainer::ToString() const {
 	std::ostringstream oss;
@@ -56,36 +57,6 @@ std::string GrammarSymbolSetTable::ToString() const {
 	return oss.str();
 }
 
-void FirstSetTable::GetFirstSet(GrammarSymbolSet& answer, SymbolVector::iterator first, SymbolVector::iterator last) {
-	for (; first != last; ++first) {
-		iterator pos = find(*first);
-		if (pos == end()) {
-			Assert(first->SymbolType() == GrammarSymbolTerminal, "invalid symbol" + first->ToString());
-			answer.insert(*first); 
-			break;
-		}
-
-		GrammarSymbolSet& firstSet = pos->second;
-		bool hasEpsilon = false;
-		for (GrammarSymbolSet::iterator ite = firstSet.begin(); ite != firstSet.end(); ++ite) {
-			if (*ite != NativeSymbols::epsilon) {
-				answer.insert(*ite);
-			}
-			else {
-				hasEpsilon = true;
-			}
-		}
-
-		if (!hasEpsilon) {
-			break;
-		}
-	}
-
-	if (first == last) {
-		answer.insert(NativeSymbols::epsilon);
-	}
-}
-
 GrammarSymbol SymbolFactory::Create(const std::string& text) {
 	if (Utility::IsTerminal(text)) {
 		return new TerminalSymbol(text);
@@ -94,14 +65,20 @@ GrammarSymbol SymbolFactory::Create(const std::string& text) {
 	return new NonterminalSymbol(text);
 }
 
-void NativeSymbols::Copy(GrammarSymbolContainer& terminalSymbols, GrammarSymbolContainer& nonterminalSymbols) {
+void NativeSymbols::Copy(GrammarSymbolContainer& terminalSymbols) {
 	terminalSymbols.insert(std::make_pair(zero.ToString(), zero));
 	terminalSymbols.insert(std::make_pair(number.ToString(), number));
 	terminalSymbols.insert(std::make_pair(string.ToString(), string));
 	terminalSymbols.insert(std::make_pair(epsilon.ToString(), epsilon));
 	terminalSymbols.insert(std::make_pair(identifier.ToString(), identifier));
+}
 
-	nonterminalSymbols.insert(std::make_pair(program.ToString(), program));
+void NativeSymbols::CopyTerminals(SymbolVector& symbols) {
+	GrammarSymbol terminals[] = { zero, unknown, number, string, epsilon, identifier };
+	for (int i = 0; i < TerminalCount; ++i) {
+		Assert(terminals[i].GetID() == (int)symbols.size(), "invalid native symbol id " + terminals[i].ToString());
+		symbols.push_back(terminals[i]);
+	}
 }
 
 bool NativeSymbols::IsNative(const GrammarSymbol& symbol) {
@@ -111,6 +88,6 @@ bool NativeSymbols::IsNative(const GrammarSymbol& symbol) {
 		|| symbol == string
 		|| symbol == unknown
 		|| symbol == epsilon
-		|| symbol == program
-		|| symbol == identifier;
+		|| symbol == identifier
+		|| (symbol.SymbolType() == GrammarSymbolNonterminal && symbol.ToString() == programText);
 }
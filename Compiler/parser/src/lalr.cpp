@@ -1,3 +1,5 @@
+#include <queue>
+#include <thread>
 #include <sstream>
 #include <algorithm>
 
@@ -28,7 +30,7 @@ private:
 	container_type container_;
 };
 
-LALR::LALR() :coreItemsCount_(0){
+LALR::LALR() :symbolCount_(0) {
 	ambiguities_ = new Ambiguities;
 }
 
@@ -36,25 +38,34 @@ LALR::~LALR() {
 	delete ambiguities_;
 }
 
-void LALR::Setup(Environment* env, FirstSetTable* firstSets) {
+void LALR::Setup(Environment* env, FirstSetTable* firstSets, const GrammarSymbolSetTable* followSets, const CondinateTable* condinates) {
 	env_ = env;
 	firstSets_ = firstSets;
+	followSets_ = followSets;
+	condinates_ = condinates;
 }
 
 bool LALR::Parse(LRActionTable& actionTable, LRGotoTable& gotoTable) {
 	Debug::StartSample("create LR0 itemsets");
 	LR0 lr0;
-	lr0.Setup(env_, firstSets_);
-	lr0.CreateLR0Itemsets(itemsets_, edges_);
+	lr0.Setup(env_, condinates_);
+	lr0.CreateLR0Itemsets(states_, edges_);
 	Debug::EndSample();
-	
-	coreItemsCount_ = 0;
-	for (LR1ItemsetContainer::iterator ite = itemsets_.begin(); ite != itemsets_.end(); ++ite) {
-		coreItemsCount_ += std::count_if(ite->begin(), ite->end(), std::mem_fun_ref(&LR1Item::IsCore));
-	}
 
-	LR1Item init = *itemsets_.begin()->begin();
-	init.GetForwards().insert(NativeSymbols::zero);
+	CreateItemIDs();
+	CalculateForwards();
+	InternForwards();
+
+	Debug::StartSample("create parsing table");
+	bool status = CreateLRParsingTable(gotoTable, actionTable);
+	Debug::EndSample();
+
+	return status;
+}
+
+void LALR::CalculateForwards() {
+	// program : . X
+	forwards_[itemIDs_[0]].insert(NativeSymbols::zero);
 
 	Debug::StartSample("calculate forwards and propagations");
 	CalculateForwardsAndPropagations();
@@ -63,12 +74,6 @@ bool LALR::Parse(LRActionTable& actionTable, LRGotoTable& gotoTable) {
 	Debug::StartSample("propagate forwards");
 	PropagateSymbols();
 	Debug::EndSample();
-
-	Debug::StartSample("create parsing table");
-	bool status = CreateLRParsingTable(gotoTable, actionTable);
-	Debug::EndSample();
-
-	return status;
 }
 
 bool LALR::CreateLRParsingTable(LRGotoTable& gotoTable, LRActionTable& actionTable) {
@@ -81,19 +86,61 @@ bool LALR::CreateLRParsingTable(LRGotoTable& gotoTable, LRActionTable& actionTab
 }
 
 bool LALR::CreateActionTable(LRActionTable &actionTable) {
-	for (LR1ItemsetContainer::iterator ite = itemsets_.begin(); ite != itemsets_.end(); ++ite) {
-		const LR1Itemset& itemset = *ite;
-		for (LR1Itemset::const_iterator ite2 = itemset.begin(); ite2 != itemset.end(); ++ite2) {
-			const LR1Item& item = *ite2;
-			ParseLRAction(actionTable, itemset, item);
+	// items that are not kept only shift, they need no forwards.
+	Forwards none;
+
+	LR1Itemset itemset;
+	for (int i = 0; i < (int)states_.size(); ++i) {
+		condinates_->CalculateClosure(states_[i], itemset);
+		for (int j = 0; j < itemset.size(); ++j) {
+			int index = states_[i].IndexOf(itemset[j]);
+			ParseLRAction(actionTable, i, itemset[j], (index >= 0) ? GetForwards(itemIDs_[i] + index) : none);
 		}
 	}
 
 	return true;
 }
 
-bool LALR::InsertActionTable(LRActionTable& actionTable, const LR1Itemset& src, const GrammarSymbol& symbol, const LRAction& action) {
-	int state = Utility::ParseInteger(src.GetName());
+void LALR::CreateItemIDs() {
+	symbolCount_ = (int)env_->symbols.size();
+
+	itemIDs_.resize(states_.size() + 1);
+	itemIDs_[0] = 0;
+	for (int i = 0; i < (int)states_.size(); ++i) {
+		itemIDs_[i + 1] = itemIDs_[i] + states_[i].size();
+	}
+
+	forwards_.assign(itemIDs_.back(), Forwards());
+}
+
+int LALR::GetGoto(int state, const GrammarSymbol& symbol) const {
+	return edges_.get(state, symbol.GetID());
+}
+
+int LALR::GetItemID(int state, const LR1Item& item) const {
+	int index = states_[state].IndexOf(item);
+	Assert(index >= 0, "can not find item.");
+	return itemIDs_[state] + index;
+}
+
+const Forwards& LALR::GetForwards(int id) const {
+	return lookaheads_[lookaheadIDs_[id]];
+}
+
+void LALR::InternForwards() {
+	lookaheads_.clear();
+	lookaheadIDs_.resize(forwards_.size());
+	for (int i = 0; i < (int)forwards_.size(); ++i) {
+		lookaheadIDs_[i] = lookaheads_.insert(forwards_[i]);
+	}
+
+	// forwards are fixed from now on.
+	ForwardsVector().swap(forwards_);
+	Propagations().swap(propagations_);
+	arena_.Release();
+}
+
+bool LALR::InsertActionTable(LRActionTable& actionTable, int state, const GrammarSymbol& symbol, const LRAction& action) {
 	LRActionTable::ib_pair status = actionTable.insert(state, symbol, action);
 	if (!status.second && status.first->second != action) {
 		Ambiguity ambiguity = { state, symbol, status.first->second, action };
@@ -114,23 +161,23 @@ bool LALR::InsertActionTable(LRActionTable& actionTable, const LR1Itemset& src,
 	return true;
 }
 
-bool LALR::ParseLRAction(LRActionTable & actionTable, const LR1Itemset& itemset, const LR1Item &item) {
+bool LALR::ParseLRAction(LRActionTable & actionTable, int state, const LR1Item &item, const Forwards& forwards) {
 	Grammar* g = nullptr;
 	const Condinate* cond = env_->grammars.GetTargetCondinate(item.GetCpos(), &g);
 
-	if (g->GetLhs() == NativeSymbols::program && item.GetDpos() == 1 
-		&& item.GetForwards().size() == 1 && *item.GetForwards().begin() == NativeSymbols::zero) {
+	if (g->GetLhs() == env_->program && item.GetDpos() == 1 
+		&& forwards.size() == 1 && forwards.contains(NativeSymbols::zero)) {
 		LRAction action = { LRActionAccept };
-		return InsertActionTable(actionTable, itemset, NativeSymbols::zero, action);
+		return InsertActionTable(actionTable, state, NativeSymbols::zero, action);
 	}
 
 	if (item.GetDpos() >= (int)cond->symbols.size() || cond->symbols.front() == NativeSymbols::epsilon) {
 		bool status = true;
 
-		if (g->GetLhs() != NativeSymbols::program) {
+		if (g->GetLhs() != env_->program) {
 			LRAction action = { LRActionReduce, item.GetCpos() };
-			for (Forwards::const_iterator fi = item.GetForwards().begin(); fi != item.GetForwards().end(); ++fi) {
-				status = InsertActionTable(actionTable, itemset, *fi, action) || status;
+			for (Forwards::const_iterator fi = forwards.begin(); fi != forwards.end(); ++fi) {
+				status = InsertActionTable(actionTable, state, env_->symbols[*fi], action) || status;
 			}
 		}
 
@@ -139,11 +186,10 @@ bool LALR::ParseLRAction(LRActionTable & actionTable, const LR1Itemset& itemset,
 
 	const GrammarSymbol& symbol = cond->symbols[item.GetDpos()];
 	if (symbol.SymbolType() == GrammarSymbolTerminal) {
-		LR1Itemset target;
-		if (edges_.get(itemset, symbol, target)) {
-			int j = Utility::ParseInteger(target.GetName());
+		int j = GetGoto(state, symbol);
+		if (j >= 0) {
 			LRAction action = { LRActionShift, j };
-			return InsertActionTable(actionTable, itemset, symbol, action);
+			return InsertActionTable(actionTable, state, symbol, action);
 		}
 	}
 
@@ -152,120 +198,97 @@ bool LALR::ParseLRAction(LRActionTable & actionTable, const LR1Itemset& itemset,
 
 
 bool LALR::CreateGotoTable(LRGotoTable &gotoTable) {
-	for (LR1EdgeTable::const_iterator ite = edges_.begin(); ite != edges_.end(); ++ite) {
-		const GrammarSymbol& symbol = ite->first.second;
-		if (symbol.SymbolType() == GrammarSymbolNonterminal) {
-			int i = Utility::ParseInteger(ite->first.first.GetName());
-			int j = Utility::ParseInteger(ite->second.GetName());
-			gotoTable.insert(i, symbol, j);
+	for (int i = 0; i < (int)states_.size(); ++i) {
+		for (int id = env_->TerminalCount(); id < symbolCount_; ++id) {
+			int j = edges_.get(i, id);
+			if (j >= 0) {
+				gotoTable.insert(i, env_->symbols[id], j);
+			}
 		}
 	}
 
 	return true;
 }
 
-void LALR::CalculateLR1Itemset(LR1Itemset& answer, LR1Itemset& itemset) {
-	for (; CalculateLR1ItemsetOnePass(answer, itemset);) {
-	}
-}
+void LALR::CalculateClosure(const LR1Itemset& itemset, ForwardsVector& closure) const {
+	for (bool changed = true; changed;) {
+		changed = false;
+		for (int i = 0; i < itemset.size(); ++i) {
+			if (closure[i].empty()) {
+				continue;
+			}
 
-bool LALR::CalculateLR1ItemsetOnePass(LR1Itemset& answer, LR1Itemset& itemset) {
-	LR1Itemset newItems;
+			const LR1Item& current = itemset[i];
+			const Condinate* cond = env_->grammars.GetTargetCondinate(current.GetCpos(), nullptr);
 
-	for (LR1Itemset::iterator isi = answer.begin(); isi != answer.end(); ++isi) {
-		const LR1Item& current = *isi;
-		const Condinate* cond = env_->grammars.GetTargetCondinate(current.GetCpos(), nullptr);
+			if (current.GetDpos() >= (int)cond->symbols.size()) {
+				continue;
+			}
 
-		if (current.GetDpos() >= (int)cond->symbols.size()) {
-			continue;
-		}
+			const GrammarSymbol& lhs = cond->symbols[current.GetDpos()];
 
-		const GrammarSymbol& lhs = cond->symbols[current.GetDpos()];
+			if (lhs.SymbolType() == GrammarSymbolTerminal) {
+				continue;
+			}
 
-		if (lhs.SymbolType() == GrammarSymbolTerminal) {
-			continue;
+			// copy, closure[i] itself may grow.
+			Forwards forwards = closure[i];
+			changed = AddLR1Items(itemset, lhs, current, forwards, closure) || changed;
 		}
-
-		AddLR1Items(newItems, lhs, current, itemset);
 	}
+}
 
-	bool setChanged = false;
-	for (LR1Itemset::const_iterator ite = newItems.begin(); ite != newItems.end(); ++ite) {
-		setChanged = answer.insert(*ite) || setChanged;
+bool LALR::AddLR1Items(const LR1Itemset& itemset, const GrammarSymbol& lhs, const LR1Item& current, const Forwards& forwards, ForwardsVector& closure) const {
+	// FIRST(beta forwards) is the cached FIRST(beta), unless beta is nullable.
+	const Forwards& suffix = condinates_->GetFirstSet(current.GetCpos(), current.GetDpos() + 1);
+	if (!condinates_->IsNullableSuffix(current.GetCpos(), current.GetDpos() + 1)) {
+		return AddLR1Items(itemset, lhs, suffix, closure);
 	}
 
-	return setChanged;
+	Forwards firsts = suffix;
+	firsts.merge(forwards);
+	return AddLR1Items(itemset, lhs, firsts, closure);
 }
 
-void LALR::AddLR1Items(LR1Itemset &answer, const GrammarSymbol& lhs, const LR1Item &current, LR1Itemset& itemset) {
-	int gi = 1;
-	GrammarSymbolSet firstSet;
-	
-	Grammar* grammar = env_->grammars.FindGrammar(lhs, &gi);
-	const Condinate* srcCond = env_->grammars.GetTargetCondinate(current.GetCpos(), nullptr);
-
-	SymbolVector beta(srcCond->symbols.begin() + current.GetDpos() + 1, srcCond->symbols.end());
-	beta.push_back(NativeSymbols::null);
-
-	int condinateIndex = 0;
-	const CondinateContainer& conds = grammar->GetCondinates();
-
-	for (CondinateContainer::const_iterator ci = conds.begin(); ci != conds.end(); ++ci, ++condinateIndex) {
-		const Condinate* tc = *ci;
-		Forwards forwards = current.GetForwards();
-		for (Forwards::const_iterator fi = forwards.begin(); fi != forwards.end(); ++fi) {
-			beta.back() = *fi;
-			firstSets_->GetFirstSet(firstSet, beta.begin(), beta.end());
-
-			for (GrammarSymbolSet::const_iterator fsi = firstSet.begin(); fsi != firstSet.end(); ++fsi) {
-				SymbolVector::const_iterator ite = tc->symbols.begin();
-				int dpos = 0;
-
-				for (; ite != tc->symbols.end(); ++ite, ++dpos) {
-					LR1Item newItem = FindItem(Utility::MakeDword(condinateIndex, gi), dpos, itemset);
-					newItem.GetForwards().insert(*fsi);
-					answer.insert(newItem);
-
-					if (*ite == NativeSymbols::epsilon || !IsNullable(*ite)) {
-						break;
-					}
-				}
-
-				if (ite == tc->symbols.end()) {
-					LR1Item newItem = FindItem(Utility::MakeDword(condinateIndex, gi), dpos, itemset);
-					newItem.GetForwards().insert(*fsi);
-					answer.insert(newItem);
-				}
-			}
-
-			firstSet.clear();
+bool LALR::AddLR1Items(const LR1Itemset& itemset, const GrammarSymbol& lhs, const Forwards& firsts, ForwardsVector& closure) const {
+	bool changed = false;
+	int last = condinates_->GetLastCondinate(lhs);
+	for (int id = condinates_->GetFirstCondinate(lhs); id < last; ++id) {
+		int cpos = condinates_->GetCpos(id);
+		for (int dpos = 0; dpos <= condinates_->GetClosureEnd(id); ++dpos) {
+			int index = itemset.IndexOf(LR1Item(cpos, dpos));
+			changed = closure[index].merge(firsts) || changed;
 		}
 	}
-}
-
-bool LALR::IsNullable(const GrammarSymbol& symbol) {
-	GrammarSymbolSet& firsts = firstSets_->at(symbol);
-	return firsts.find(NativeSymbols::epsilon) != firsts.end();
-}
 
-LR1Item LALR::FindItem(int cpos, int dpos, LR1Itemset& dict) {
-	tmp_.SetCpos(cpos);
-	tmp_.SetDpos(dpos);
-	LR1Itemset::iterator pos = dict.find(tmp_);
-	Assert(pos != dict.end(), "can not find item.");
-	return *pos;
+	return changed;
 }
 
 std::string LALR::ToString() const {
 	std::ostringstream oss;
 	
 	oss << Utility::Heading(" LR1 Edges ") << "\n";
-	oss << edges_.ToString(env_->grammars);
+	oss << edges_.ToString(*env_);
 
 	oss << "\n\n";
 
 	oss << Utility::Heading(" LR1 Itemsets ") << "\n";
-	oss << itemsets_.ToString(env_->grammars);
+	for (int i = 0; i < (int)states_.size(); ++i) {
+		oss << "(" << i << ") { ";
+
+		const char* seperator = "";
+		for (int j = 0; j < states_[i].size(); ++j) {
+			if (!states_[i][j].IsCore()) {
+				continue;
+			}
+
+			oss << seperator;
+			seperator = ", ";
+			oss << "{ " << states_[i][j].ToString(*env_) << ", ( " << GetForwards(itemIDs_[i] + j).ToString(env_->symbols) << " ) }";
+		}
+
+		oss << " }\n";
+	}
 
 	oss << "\n\n";
 
@@ -293,13 +316,13 @@ std::string LALR::ToString() const {
 
 	tp.AddHeader();
 
-	for (LR1ItemsetContainer::const_iterator ite = itemsets_.begin(); ite != itemsets_.end(); ++ite) {
-		tp << ite->GetName();
-		LR1Itemset target;
+	for (int i = 0; i < (int)states_.size(); ++i) {
+		tp << i;
 		for (GrammarSymbolContainer::const_iterator ite2 = env_->terminalSymbols.begin(); 
 			ite2 != env_->terminalSymbols.end(); ++ite2) {
-			if (edges_.get(*ite, ite2->second, target)) {
-				tp << target.GetName();
+			int target = edges_.get(i, ite2->second.GetID());
+			if (target >= 0) {
+				tp << target;
 			}
 			else {
 				tp << "";
@@ -308,8 +331,9 @@ std::string LALR::ToString() const {
 
 		for (GrammarSymbolContainer::const_iterator ite2 = env_->nonterminalSymbols.begin();
 			ite2 != env_->nonterminalSymbols.end(); ++ite2) {
-			if (edges_.get(*ite, ite2->second, target)) {
-				tp << target.GetName();
+			int target = edges_.get(i, ite2->second.GetID());
+			if (target >= 0) {
+				tp << target;
 			}
 			else {
 				tp << "";
@@ -325,121 +349,126 @@ std::string LALR::ToString() const {
 }
 
 void LALR::PropagateSymbols() {
-	for (; PropagateSymbolsOnePass();) {
-	}
-}
-
-bool LALR::PropagateSymbolsOnePass() {
-	bool propagated = false;
-
-	for (LR1ItemsetContainer::iterator ite = itemsets_.begin(); ite != itemsets_.end(); ++ite) {
-		for (LR1Itemset::iterator ii = ite->begin(); ii != ite->end(); ++ii) {
-			propagated = PropagateFrom(*ii) || propagated;
+	std::queue<int> queue;
+	for (int i = 0; i < (int)forwards_.size(); ++i) {
+		if (!forwards_[i].empty() && !propagations_[i].empty()) {
+			queue.push(i);
 		}
 	}
 
-	return propagated;
-}
-
-bool LALR::PropagateFrom(const LR1Item &src) {
-	Propagations::iterator pos = propagations_.find(src);
-	if (pos == propagations_.end()) {
-		return false;
-	}
-
-	bool propagated = false;
-	const Forwards& forwards = src.GetForwards();
-	
-	LR1Itemset& itemset = (LR1Itemset&)pos->second;
-	for (LR1Itemset::iterator is = itemset.begin(); is != itemset.end(); ++is) {
-		LR1Item& target = (LR1Item&)*is;
-		for (Forwards::const_iterator fi = forwards.begin(); fi != forwards.end(); ++fi) {
-			propagated = target.GetForwards().insert(*fi) || propagated;
+	// Only items whose forwards grew are propagated again.
+	for (; !queue.empty(); queue.pop()) {
+		int src = queue.front();
+		const Propagations::value_type& targets = propagations_[src];
+		for (Propagations::value_type::const_iterator ite = targets.begin(); ite != targets.end(); ++ite) {
+			if (forwards_[*ite].merge(forwards_[src])) {
+				queue.push(*ite);
+			}
 		}
 	}
-
-	return propagated;
 }
 
 void LALR::CalculateForwardsAndPropagations() {
-	Debug::StartSample("add forwards and propagations");
-	Debug::StartProgress();
-	int index = 1;
-	LR1Itemset target = nullptr;
-	for (LR1ItemsetContainer::iterator ite = itemsets_.begin(); ite != itemsets_.end(); ++ite) {
-		LR1Itemset& dict = (LR1Itemset&)*ite;
-		
-		for (LR1Itemset::iterator ii = dict.begin(); ii != dict.end(); ++ii) {
-			LR1Item item = *ii;
-			if (!item.IsCore()) {
-				continue;
+	CoreVector cores;
+	for (int i = 0; i < (int)states_.size(); ++i) {
+		for (int j = 0; j < states_[i].size(); ++j) {
+			if (states_[i][j].IsCore()) {
+				cores.push_back(std::make_pair(i, j));
 			}
+		}
+	}
 
-			Debug::LogProgress("progress", index, coreItemsCount_);
-			LR1Itemset itemset;
+	int threadCount = std::min((int)std::thread::hardware_concurrency(), (int)cores.size());
+	threadCount = std::max(threadCount, 1);
 
-			item.GetForwards().insert(NativeSymbols::unknown);
-			itemset.insert(item);
+	// each thread takes a contiguous range of cores, the calling thread takes the first one.
+	std::vector<ForwardsBatch> batches(threadCount, ForwardsBatch(&arena_));
+	std::vector<std::thread> threads;
+	for (int i = 1; i < threadCount; ++i) {
+		int first = (int)cores.size() * i / threadCount, last = (int)cores.size() * (i + 1) / threadCount;
+		threads.push_back(std::thread(&LALR::CalculateBatch, this, std::cref(cores), first, last, &batches[i]));
+	}
 
-			CalculateLR1Itemset(itemset, dict);
+	CalculateBatch(cores, 0, (int)cores.size() / threadCount, &batches[0]);
 
-			GrammarSymbolContainer::iterator si = env_->terminalSymbols.begin();
-			for (; si != env_->terminalSymbols.end(); ++si) {
-				if (edges_.get(dict, si->second, target)) {
-					AddForwardsAndPropagations(item, itemset, target, si->second);
-				}
-			}
+	for (std::vector<std::thread>::iterator ite = threads.begin(); ite != threads.end(); ++ite) {
+		ite->join();
+	}
 
-			si = env_->nonterminalSymbols.begin();
-			for (; si != env_->nonterminalSymbols.end(); ++si) {
-				if (si->second != NativeSymbols::program && edges_.get(dict, si->second, target)) {
-					AddForwardsAndPropagations(item, itemset, target, si->second);
-				}
-			}
+	// merge in the order of cores, so the result does not depend on threadCount.
+	propagations_.assign(forwards_.size(), Propagations::value_type(&arena_));
+	for (std::vector<ForwardsBatch>::const_iterator ite = batches.begin(); ite != batches.end(); ++ite) {
+		for (ItemForwardsVector::const_iterator fi = ite->forwards.begin(); fi != ite->forwards.end(); ++fi) {
+			forwards_[fi->first].merge(fi->second);
+		}
 
-			++index;
+		for (PropagationVector::const_iterator pi = ite->propagations.begin(); pi != ite->propagations.end(); ++pi) {
+			propagations_[pi->first].push_back(pi->second);
 		}
 	}
+}
 
-	Debug::EndProgress();
-	Debug::EndSample();
-
-	Debug::StartSample("clean up");
-	for (LR1ItemsetContainer::iterator ite = itemsets_.begin(); ite != itemsets_.end(); ++ite) {
-		for (LR1Itemset::iterator ii = ite->begin(); ii != ite->end(); ++ii) {
-			Forwards& forwards = (Forwards&)ii->GetForwards();
-			forwards.erase(NativeSymbols::unknown);
+void LALR::CalculateBatch(const CoreVector& cores, int first, int last, ForwardsBatch* batch) const {
+	// cores of a state are consecutive, so is its closure computed once.
+	LR1Itemset itemset;
+	ForwardsVector closure;
+	for (int i = first, current = -1; i < last; ++i) {
+		int state = cores[i].first, core = cores[i].second;
+		if (state != current) {
+			condinates_->CalculateClosure(states_[state], itemset);
+			current = state;
 		}
-	}
 
-	Debug::EndSample();
+		// forwards of the closure of this single item, # stands for its own forwards.
+		closure.assign(itemset.size(), Forwards());
+		closure[itemset.IndexOf(states_[state][core])].insert(NativeSymbols::unknown);
+		CalculateClosure(itemset, closure);
+
+		AddForwardsAndPropagations(state, core, itemset, closure, *batch);
+	}
 }
 
-void LALR::AddForwardsAndPropagations(LR1Item& src, const LR1Itemset& itemset, LR1Itemset& dict, const GrammarSymbol& symbol) {
-	for (LR1Itemset::iterator ite = itemset.begin(); ite != itemset.end(); ++ite) {
-		const Condinate* cond = env_->grammars.GetTargetCondinate(ite->GetCpos(), nullptr);
-		if (ite->GetDpos() >= (int)cond->symbols.size()) {
+void LALR::AddForwardsAndPropagations(int state, int core, const LR1Itemset& itemset, const ForwardsVector& closure, ForwardsBatch& batch) const {
+	int src = itemIDs_[state] + core;
+
+	for (int i = 0; i < itemset.size(); ++i) {
+		if (closure[i].empty()) {
 			continue;
 		}
 
-		if (cond->symbols.front() == NativeSymbols::epsilon) {
+		Forwards forwards = closure[i];
+		bool propagated = forwards.contains(NativeSymbols::unknown);
+		forwards.erase(NativeSymbols::unknown);
+
+		// items of the closure itself, e.g. reductions of epsilon condinates.
+		// the others are not kept and only need their forwards for the gotos below.
+		int index = states_[state].IndexOf(itemset[i]);
+		if (index >= 0) {
+			int target = itemIDs_[state] + index;
+			if (propagated && target != src) {
+				batch.propagations.push_back(std::make_pair(src, target));
+			}
+
+			batch.forwards.push_back(std::make_pair(target, forwards));
+		}
+
+		const LR1Item& item = itemset[i];
+		const Condinate* cond = env_->grammars.GetTargetCondinate(item.GetCpos(), nullptr);
+		if (item.GetDpos() >= (int)cond->symbols.size() || cond->symbols.front() == NativeSymbols::epsilon) {
 			continue;
 		}
 
-		if (cond->symbols[ite->GetDpos()] != symbol) {
+		const GrammarSymbol& symbol = cond->symbols[item.GetDpos()];
+		if (symbol == env_->program) {
 			continue;
 		}
 
-		LR1Item target = FindItem(ite->GetCpos(), ite->GetDpos() + 1, dict);
-		const Forwards& forwards = ite->GetForwards();
-		for (Forwards::const_iterator ite2 = forwards.begin(); ite2 != forwards.end(); ++ite2) {
-			if (*ite2 == NativeSymbols::unknown) {
-				propagations_[src].insert(target);
-			}
-			else {
-				target.GetForwards().insert(*ite2);
-			}
+		int target = GetItemID(GetGoto(state, symbol), LR1Item(item.GetCpos(), item.GetDpos() + 1));
+		if (propagated) {
+			batch.propagations.push_back(std::make_pair(src, target));
 		}
+
+		batch.forwards.push_back(std::make_pair(target, forwards));
 	}
 }
 
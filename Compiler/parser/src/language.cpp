@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "debug.h"
 #include "reader.h"
 #include "parser.h"
@@ -6,7 +8,7 @@
 #include "syntaxer.h"
 #include "lr_parser.h"
 
-Language::Language() {
+Language::Language(LRImplType type, LRTableEncoding encoding) : type_(type), encoding_(encoding) {
 	env_ = new Environment;
 	syntaxer_ = new Syntaxer;
 }
@@ -16,7 +18,7 @@ Language::~Language() {
 	delete syntaxer_;
 }
 
-void Language::Setup(const char* productions, const char* fileName) {
+void Language::Setup(const char* productions, const char* fileName, bool compact) {
 	time_t tp = OS::GetFileLastWriteTime(productions);
 	time_t to = OS::GetFileLastWriteTime(fileName);
 	if (true || tp > to) {
@@ -26,30 +28,160 @@ void Language::Setup(const char* productions, const char* fileName) {
 		Debug::EndSample();
 	}
 	else {
-		Debug::StartSample("load parser");
-		LoadSyntaxer(fileName);
-		Debug::EndSample();
+		Load(fileName);
+	}
+
+	// the generator is gone already, the tables it built are dropped once saved.
+	if (compact) {
+		syntaxer_->Compact();
 	}
 }
 
+void Language::Load(const char* fileName) {
+	Debug::StartSample("load parser");
+	LoadSyntaxer(fileName);
+	Debug::EndSample();
+}
+
 bool Language::Parse(SyntaxTree* tree, const std::string& file) {
 	FileScanner scanner(file.c_str());
 	return syntaxer_->ParseSyntax(tree, &scanner);
 }
 
 bool Language::SetupEnvironment(const char* productions) {
-	NativeSymbols::Copy(env_->terminalSymbols, env_->nonterminalSymbols);
+	env_->AddNativeSymbols();
 
 	if (!ParseProductions(productions)) {
 		return false;
 	}
 
 	Assert(!env_->grammars.empty(), "grammar container is empty");
-	Assert(env_->grammars.front()->GetLhs() == NativeSymbols::program, "invalid grammar. missing \"Program\".");
+	Assert(env_->grammars.front()->GetLhs() == env_->program, "invalid grammar. missing \"Program\".");
+
+	env_->NumberSymbols();
+
+	if (RemoveUselessSymbols()) {
+		env_->NumberSymbols();
+	}
 
 	return true;
 }
 
+bool Language::RemoveUselessSymbols() {
+	std::vector<bool> productives;
+	FindProductiveSymbols(productives);
+	Assert(productives[env_->program.GetID()], "invalid grammar. \"Program\" derives no sentence.");
+
+	int productions = 0, symbols = 0;
+	for (GrammarContainer::iterator ite = env_->grammars.begin(); ite != env_->grammars.end(); ++ite) {
+		const CondinateContainer& conds = (*ite)->GetCondinates();
+		for (int i = 0; i < (int)conds.size();) {
+			const SymbolVector& rhs = conds[i]->symbols;
+			SymbolVector::const_iterator pos = rhs.begin();
+			for (; pos != rhs.end() && productives[pos->GetID()]; ++pos) {
+			}
+
+			if (pos == rhs.end()) {
+				++i;
+				continue;
+			}
+
+			Debug::LogWarning("remove production " + (*ite)->GetLhs().ToString() + " : " + conds[i]->ToString()
+				+ ", " + pos->ToString() + " derives no sentence.");
+			(*ite)->RemoveCondinate(i);
+			++productions;
+		}
+	}
+
+	// grammars left without condinates are unreachable now.
+	std::vector<bool> reachables;
+	FindReachableSymbols(reachables);
+
+	for (GrammarContainer::iterator ite = env_->grammars.begin(); ite != env_->grammars.end();) {
+		if (reachables[(*ite)->GetLhs().GetID()]) {
+			++ite;
+			continue;
+		}
+
+		productions += (int)(*ite)->GetCondinates().size();
+		delete *ite;
+		ite = env_->grammars.erase(ite);
+	}
+
+	for (GrammarSymbolContainer::iterator ite = env_->nonterminalSymbols.begin(); ite != env_->nonterminalSymbols.end();) {
+		if (reachables[ite->second.GetID()]) {
+			++ite;
+			continue;
+		}
+
+		Debug::LogWarning("remove symbol " + ite->first + (productives[ite->second.GetID()] ? ", it is unreachable from Program." : ", it derives no sentence."));
+		ite = env_->nonterminalSymbols.erase(ite);
+		++symbols;
+	}
+
+	if (productions == 0 && symbols == 0) {
+		return false;
+	}
+
+	Debug::LogWarning(Utility::Format("%d useless symbols and %d useless productions removed.", symbols, productions));
+	return true;
+}
+
+void Language::FindProductiveSymbols(std::vector<bool>& answer) {
+	// terminals, including epsilon, derive themselves.
+	answer.assign(env_->symbols.size(), false);
+	std::fill(answer.begin(), answer.begin() + env_->TerminalCount(), true);
+
+	for (bool changed = true; changed;) {
+		changed = false;
+		for (GrammarContainer::const_iterator ite = env_->grammars.begin(); ite != env_->grammars.end(); ++ite) {
+			int lhs = (*ite)->GetLhs().GetID();
+			const CondinateContainer& conds = (*ite)->GetCondinates();
+			for (CondinateContainer::const_iterator ite2 = conds.begin(); ite2 != conds.end() && !answer[lhs]; ++ite2) {
+				const SymbolVector& rhs = (*ite2)->symbols;
+				SymbolVector::const_iterator pos = rhs.begin();
+				for (; pos != rhs.end() && answer[pos->GetID()]; ++pos) {
+				}
+
+				if (pos == rhs.end()) {
+					answer[lhs] = changed = true;
+				}
+			}
+		}
+	}
+}
+
+void Language::FindReachableSymbols(std::vector<bool>& answer) {
+	// grammar of each lhs, -1 if there is none.
+	std::vector<int> grammars(env_->symbols.size(), -1);
+	for (int i = 0; i < (int)env_->grammars.size(); ++i) {
+		grammars[env_->grammars[i]->GetLhs().GetID()] = i;
+	}
+
+	answer.assign(env_->symbols.size(), false);
+	std::vector<int> stack(1, env_->program.GetID());
+	answer[stack.back()] = true;
+
+	for (; !stack.empty();) {
+		int gi = grammars[stack.back()];
+		stack.pop_back();
+		if (gi < 0) {
+			continue;
+		}
+
+		const CondinateContainer& conds = env_->grammars[gi]->GetCondinates();
+		for (CondinateContainer::const_iterator ite = conds.begin(); ite != conds.end(); ++ite) {
+			const SymbolVector& rhs = (*ite)->symbols;
+			for (SymbolVector::const_iterator ite2 = rhs.begin(); ite2 != rhs.end(); ++ite2) {
+				if (!answer[ite2->GetID()]) {
+					answer[ite2->GetID()] = true;
+					stack.push_back(ite2->GetID());
+				}
+			}
+		}
+	}
+}
+
 GrammarSymbol Language::CreateSymbol(const std::string& text) {
 	GrammarSymbolContainer* target = nullptr;
 	if (Utility::IsTerminal(text)) {
@@ -115,7 +247,7 @@ bool Language::ParseProductions(const char* productions) {
 
 void Language::BuildSyntaxer(const char* productions) {
 	SetupEnvironment(productions);
-	LRParser parser;
+	LRParser parser(type_, encoding_);
 	parser.Setup(*syntaxer_, env_);
 }
 
@@ -136,3 +268,14 @@ void Language::SaveSyntaxer(const char* fileName) {
 std::string Language::ToString() const {
 	return syntaxer_->ToString();
 }
+
+void Language::GetMemoryReport(MemoryReport& report) const {
+	report.environment = env_->GetRetainedBytes();
+	report.parsingTable = syntaxer_->GetLRTable().GetRetainedBytes();
+	report.sparseTables = syntaxer_->GetLRTable().GetSparseBytes();
+}
+
+std::string MemoryReport::ToString() const {
+	return Utility::Format("environment: %d bytes, parsing table: %d bytes, sparse tables: %d bytes.",
+		(int)environment, (int)parsingTable, (int)sparseTables);
+}
@@ -1,9 +1,13 @@
+#include <thread>
 #include <sstream>
+#include <algorithm>
+#include <functional>
 
 #include "lr0.h"
 #include "debug.h"
 #include "parser.h"
 #include "table_printer.h"
+#include "condinate_table.h"
 
 LR0::LR0() {
 }
@@ -11,163 +15,196 @@ LR0::LR0() {
 LR0::~LR0() {
 }
 
-void LR0::Setup(Environment* env, FirstSetTable* firstSets) {
+void LR0::Setup(Environment* env, const CondinateTable* condinates) {
 	env_ = env;
-	firstSets_ = firstSets;
+	condinates_ = condinates;
 }
 
-bool LR0::CreateLR0Itemsets(LR1ItemsetContainer& itemsets, LR1EdgeTable& edges) {
-	LR1Itemset itemset;
-	AddLR1Items(itemset, env_->grammars.front()->GetLhs());
-	itemset.SetName("0");
-	CalculateClosure(itemset);
-	itemsets_.insert(itemset);
+bool LR0::CreateLR0Itemsets(LR1ItemsetContainer& states, LR1EdgeTable& edges) {
+	edges_.clear((int)env_->symbols.size());
+
+	Kernel kernel(&arena_);
+	const GrammarSymbol& program = env_->grammars.front()->GetLhs();
+	int last = condinates_->GetLastCondinate(program);
+	for (int id = condinates_->GetFirstCondinate(program); id < last; ++id) {
+		for (int dpos = 0; dpos <= condinates_->GetClosureEnd(id); ++dpos) {
+			kernel.push_back(condinates_->GetCpos(id));
+			kernel.push_back(dpos);
+		}
+	}
+
+	Frontier frontier;
+	LR1Itemset closure;
+	CalculateClosure(kernel, closure);
+	AddLR1Itemset(kernel, closure, frontier);
 
-	for (; CreateLR1ItemsetsOnePass();) {
+	// states are expanded level by level, each state exactly once.
+	for (; !frontier.states.empty();) {
+		ExpandFrontier(frontier);
 	}
 
 	edges = edges_;
-	itemsets = itemsets_;
+	states.swap(states_);
+
+	kernels_.clear();
+	closures_.clear();
+	arena_.Release();
 
 	return true;
 }
 
-bool LR0::CreateLR1ItemsetsOnePass() {
-	static int pass = 0;
-	Debug::StartSample(Utility::Format("CreateLR1Itemsets (%d: %d)", ++pass, itemsets_.size()));
-	bool setChanged = false;
-	LR1ItemsetContainer cont = itemsets_;
-	for (LR1ItemsetContainer::iterator ite = cont.begin(); ite != cont.end(); ++ite) {
-		for (GrammarSymbolContainer::iterator ite2 = env_->terminalSymbols.begin(); ite2 != env_->terminalSymbols.end(); ++ite2) {
-			LR1Itemset itemset;
-			setChanged = GetLR1EdgeTarget(itemset, *ite, ite2->second) || setChanged;
-		}
-
-		for (GrammarSymbolContainer::iterator ite2 = env_->nonterminalSymbols.begin(); ite2 != env_->nonterminalSymbols.end(); ++ite2) {
-			if (ite2->second == NativeSymbols::program) {
-				continue;
-			}
+// Splits [0, count) into contiguous ranges and calls function(first, last) for each on its own thread.
+// The calling thread takes the first range.
+template <class Function>
+static void ParallelFor(int count, Function function) {
+	int threadCount = std::min((int)std::thread::hardware_concurrency(), count);
+	threadCount = std::max(threadCount, 1);
 
-			LR1Itemset itemset;
-			setChanged = GetLR1EdgeTarget(itemset, *ite, ite2->second) || setChanged;
-		}
+	std::vector<std::thread> threads;
+	for (int i = 1; i < threadCount; ++i) {
+		threads.push_back(std::thread(function, count * i / threadCount, count * (i + 1) / threadCount));
 	}
 
-	Debug::EndSample();
+	function(0, count / threadCount);
 
-	return setChanged;
+	for (std::vector<std::thread>::iterator ite = threads.begin(); ite != threads.end(); ++ite) {
+		ite->join();
+	}
 }
 
-void LR0::AddLR1Items(LR1Itemset& answer, const GrammarSymbol& lhs) {
-	int index = 0, gi = 0;
-	Grammar* g = env_->grammars.FindGrammar(lhs, &gi);
-	const CondinateContainer& conds = g->GetCondinates();
+void LR0::ExpandFrontier(Frontier& frontier) {
+	using namespace std::placeholders;
 
-	for (CondinateContainer::const_iterator ci = conds.begin(); ci != conds.end(); ++ci, ++index) {
-		const Condinate* tc = *ci;
-		SymbolVector::const_iterator ite = tc->symbols.begin();
-		int dpos = 0;
+	std::vector<KernelVector> successors(frontier.states.size());
+	ParallelFor((int)frontier.states.size(), std::bind(&LR0::CreateKernels, this, std::cref(frontier), _1, _2, &successors));
 
-		for (; ite != tc->symbols.end(); ++ite, ++dpos) {
-			LR1Item newItem(Utility::MakeDword(index, gi), dpos);
-			answer.insert(newItem);
-
-			if (*ite == NativeSymbols::epsilon || !IsNullable(*ite)) {
-				break;
+	// kernels first seen in this level, in the order of (state, symbol id).
+	std::vector<const Kernel*> kernels;
+	for (std::vector<KernelVector>::const_iterator ite = successors.begin(); ite != successors.end(); ++ite) {
+		for (KernelVector::const_iterator ite2 = ite->begin(); ite2 != ite->end(); ++ite2) {
+			std::pair<KernelContainer::iterator, bool> status = kernels_.insert(std::make_pair(ite2->second, -1));
+			if (status.second) {
+				kernels.push_back(&status.first->first);
 			}
 		}
-
-		if (ite == tc->symbols.end()) {
-			LR1Item newItem(Utility::MakeDword(index, gi), dpos);
-			answer.insert(newItem);
-		}
 	}
-}
 
-bool LR0::IsNullable(const GrammarSymbol& symbol) {
-	GrammarSymbolSet& firsts = firstSets_->at(symbol);
-	return firsts.find(NativeSymbols::epsilon) != firsts.end();
-}
+	std::vector<LR1Itemset> closures(kernels.size());
+	ParallelFor((int)kernels.size(), std::bind(&LR0::CreateClosures, this, std::cref(kernels), _1, _2, &closures));
+
+	// states are numbered in the order their kernels are first seen,
+	// so the numbering does not depend on the thread count.
+	Frontier next;
+	for (int i = 0; i < (int)kernels.size(); ++i) {
+		kernels_[*kernels[i]] = AddLR1Itemset(*kernels[i], closures[i], next);
+	}
 
-void LR0::CalculateClosure(LR1Itemset& answer) {
-	for (; CalculateClosureOnePass(answer);) {
+	for (int i = 0; i < (int)frontier.states.size(); ++i) {
+		for (KernelVector::const_iterator ite = successors[i].begin(); ite != successors[i].end(); ++ite) {
+			edges_.insert(frontier.states[i], ite->first, kernels_[ite->second]);
+		}
 	}
+
+	std::swap(frontier, next);
 }
 
-bool LR0::CalculateClosureOnePass(LR1Itemset& answer) {
-	LR1Itemset newItems;
-	for (LR1Itemset::iterator isi = answer.begin(); isi != answer.end(); ++isi) {
-		const LR1Item& current = *isi;
-		const Condinate* cond = env_->grammars.GetTargetCondinate(current.GetCpos(), nullptr);
+void LR0::CreateKernels(const Frontier& frontier, int first, int last, std::vector<KernelVector>* answer) const {
+	for (int i = first; i < last; ++i) {
+		// symbols are keyed by id, GrammarSymbol handles are not copied on worker threads.
+		KernelMap kernels(std::less<int>(), &arena_);
+		const LR1Itemset& src = frontier.closures[i];
+		for (LR1Itemset::const_iterator ite = src.begin(); ite != src.end(); ++ite) {
+			const Condinate* cond = env_->grammars.GetTargetCondinate(ite->GetCpos(), nullptr);
 
-		if (current.GetDpos() >= (int)cond->symbols.size()) {
-			continue;
-		}
+			if (cond->symbols.front() == NativeSymbols::epsilon || ite->GetDpos() >= (int)cond->symbols.size()) {
+				continue;
+			}
 
-		const GrammarSymbol& b = cond->symbols[current.GetDpos()];
+			const GrammarSymbol& symbol = cond->symbols[ite->GetDpos()];
+			if (symbol == env_->program) {
+				continue;
+			}
 
-		if (b.SymbolType() == GrammarSymbolTerminal) {
-			continue;
+			// items are ordered by (cpos, dpos), so is the kernel.
+			Kernel& kernel = kernels.insert(std::make_pair(symbol.GetID(), Kernel(&arena_))).first->second;
+			kernel.push_back(ite->GetCpos());
+			kernel.push_back(ite->GetDpos() + 1);
 		}
 
-		AddLR1Items(newItems, b);
-	}
-
-	bool setChanged = false;
-	for (LR1Itemset::const_iterator ite = newItems.begin(); ite != newItems.end(); ++ite) {
-		setChanged = answer.insert(*ite) || setChanged;
+		(*answer)[i].assign(kernels.begin(), kernels.end());
 	}
-
-	return setChanged;
 }
 
-bool LR0::GetLR1EdgeTarget(LR1Itemset& answer, const LR1Itemset& src, const GrammarSymbol& symbol) {
-	LR1EdgeTable::iterator pos = edges_.find(src, symbol);
-	if (pos != edges_.end()) {
-		answer = pos->second;
-		return false;
+void LR0::CreateClosures(const std::vector<const Kernel*>& kernels, int first, int last, std::vector<LR1Itemset>* answer) const {
+	for (int i = first; i < last; ++i) {
+		CalculateClosure(*kernels[i], (*answer)[i]);
 	}
+}
 
-	bool newSetCreated = CalculateLR1EdgeTarget(answer, src, symbol);
-	if (!answer.empty()) {
-		edges_.insert(src, symbol, answer);
-		return newSetCreated;
+void LR0::CalculateClosure(const Kernel& kernel, LR1Itemset& answer) const {
+	LR1Itemset itemset;
+	for (Kernel::const_iterator ite = kernel.begin(); ite != kernel.end(); ite += 2) {
+		itemset.insert(LR1Item(ite[0], ite[1]));
 	}
 
-	return false;
+	condinates_->CalculateClosure(itemset, answer);
 }
 
-bool LR0::CalculateLR1EdgeTarget(LR1Itemset& answer, const LR1Itemset& src, const GrammarSymbol& symbol) {
-	for (LR1Itemset::const_iterator ite = src.begin(); ite != src.end(); ++ite) {
-		const Condinate* cond = env_->grammars.GetTargetCondinate(ite->GetCpos(), nullptr);
-
-		if (cond->symbols.front() == NativeSymbols::epsilon) {
+int LR0::AddLR1Itemset(const Kernel& kernel, const LR1Itemset& closure, Frontier& frontier) {
+	size_t hash = Hash(closure);
+	std::pair<ClosureContainer::iterator, ClosureContainer::iterator> range = closures_.equal_range(hash);
+	for (ClosureContainer::iterator ite = range.first; ite != range.second; ++ite) {
+		LR1Itemset other;
+		condinates_->CalculateClosure(states_[ite->second], other);
+		if (!(other == closure)) {
 			continue;
 		}
 
-		if (ite->GetDpos() >= (int)cond->symbols.size() || cond->symbols[ite->GetDpos()] != symbol) {
-			continue;
+		// different kernels may still close to the same itemset, the state keeps the items of both.
+		for (Kernel::const_iterator ki = kernel.begin(); ki != kernel.end(); ki += 2) {
+			states_[ite->second].insert(LR1Item(ki[0], ki[1]));
 		}
 
-		LR1Item item(ite->GetCpos(), ite->GetDpos() + 1);
-		answer.insert(item);
+		return ite->second;
 	}
 
-	if (answer.empty()) {
-		return false;
-	}
+	int id = (int)states_.size();
+	closures_.insert(std::make_pair(hash, id));
 
-	CalculateClosure(answer);
+	// the rest of the closure is recomputed when needed.
+	LR1Itemset itemset;
+	for (Kernel::const_iterator ite = kernel.begin(); ite != kernel.end(); ite += 2) {
+		itemset.insert(LR1Item(ite[0], ite[1]));
+	}
 
-	std::pair<LR1ItemsetContainer::iterator, bool> status = itemsets_.insert(answer);
-	if (answer.GetName().empty()) {
-		if (status.second) {
-			answer.SetName(std::to_string(itemsets_.size() - 1));
-		}
-		else {
-			answer = *status.first;
+	for (LR1Itemset::const_iterator ite = closure.begin(); ite != closure.end(); ++ite) {
+		if (condinates_->IsReduction(ite->GetCpos(), ite->GetDpos())) {
+			itemset.insert(*ite);
 		}
 	}
 
-	return status.second;
+	states_.push_back(itemset);
+	frontier.states.push_back(id);
+	frontier.closures.push_back(closure);
+
+	return id;
+}
+
+size_t LR0::Hash(const LR1Itemset& itemset) {
+	size_t answer = 2166136261U;
+	for (LR1Itemset::const_iterator ite = itemset.begin(); ite != itemset.end(); ++ite) {
+		answer = (answer ^ (size_t)ite->GetCpos()) * 16777619U;
+		answer = (answer ^ (size_t)ite->GetDpos()) * 16777619U;
+	}
+
+	return answer;
+}
+
+size_t LR0::KernelHash::operator()(const Kernel& kernel) const {
+	size_t answer = 2166136261U;
+	for (Kernel::const_iterator ite = kernel.begin(); ite != kernel.end(); ++ite) {
+		answer = (answer ^ (size_t)*ite) * 16777619U;
+	}
+
+	return answer;
 }
@@ -4,82 +4,139 @@
 #include "lr1.h"
 #include "debug.h"
 #include "define.h"
+#include "parser.h"
 #include "grammar.h"
 
 Forwards::Forwards() {
+	clear();
 }
 
 bool Forwards::operator <(const Forwards& other) const {
-	const_iterator first1 = begin(), first2 = other.begin();
-	for (; first1 != end() && first2 != other.end(); ++first1, ++first2) {
-		if (*first1 != *first2) {
-			return *first1 < *first2;
+	return std::lexicographical_compare(words_, words_ + WordCount, other.words_, other.words_ + WordCount);
+}
+
+bool Forwards::operator ==(const Forwards& other) const {
+	return std::equal(words_, words_ + WordCount, other.words_);
+}
+
+int Forwards::size() const {
+	int count = 0;
+	for (int i = 0; i < WordCount; ++i) {
+		for (unsigned word = words_[i]; word != 0; word &= word - 1) {
+			++count;
 		}
 	}
 
-	if (first1 == end() && first2 == other.end()) {
-		return false;
-	}
+	return count;
+}
 
-	return first1 == end();
+bool Forwards::empty() const {
+	return Next(0) == MAX_TERMINAL_SYMBOLS;
+}
+
+void Forwards::clear() {
+	std::fill(words_, words_ + WordCount, 0);
 }
 
 void Forwards::erase(const GrammarSymbol& symbol) {
-	iterator pos = cont_.find(symbol);
-	if (pos != cont_.end()) {
-		cont_.erase(pos);
-	}
+	int id = symbol.GetID();
+	words_[id / WordBits] &= ~(1u << (id % WordBits));
 }
 
 bool Forwards::insert(const GrammarSymbol& symbol) {
-	return cont_.insert(symbol).second;
+	int id = symbol.GetID();
+	Assert(id >= 0 && id < MAX_TERMINAL_SYMBOLS, "invalid forward symbol " + symbol.ToString());
+
+	unsigned bit = 1u << (id % WordBits);
+	if ((words_[id / WordBits] & bit) != 0) {
+		return false;
+	}
+
+	words_[id / WordBits] |= bit;
+	return true;
 }
 
-LR1Item::LR1Item() {
-	ptr_ = new Impl;
-	ptr_->cpos = 0;
-	ptr_->dpos = 0;
+bool Forwards::contains(const GrammarSymbol& symbol) const {
+	int id = symbol.GetID();
+	return (words_[id / WordBits] & (1u << (id % WordBits))) != 0;
 }
 
-LR1Item::LR1Item(int cpos, int dpos) {
-	ptr_ = new Impl;
-	ptr_->cpos = cpos;
-	ptr_->dpos = dpos;
+bool Forwards::merge(const Forwards& other) {
+	unsigned changed = 0;
+	for (int i = 0; i < WordCount; ++i) {
+		changed |= other.words_[i] & ~words_[i];
+		words_[i] |= other.words_[i];
+	}
+
+	return changed != 0;
 }
 
-LR1Item::LR1Item(int cpos, int dpos, const Forwards& forwards) {
-	ptr_ = new Impl;
-	ptr_->cpos = cpos;
-	ptr_->dpos = dpos;
-	ptr_->forwards = forwards;
+bool Forwards::intersects(const Forwards& other) const {
+	for (int i = 0; i < WordCount; ++i) {
+		if ((words_[i] & other.words_[i]) != 0) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+int Forwards::Next(int id) const {
+	for (; id < MAX_TERMINAL_SYMBOLS;) {
+		unsigned word = words_[id / WordBits] >> (id % WordBits);
+		if (word == 0) {
+			id = (id / WordBits + 1) * WordBits;
+			continue;
+		}
+
+		for (; (word & 1) == 0; word >>= 1) {
+			++id;
+		}
+
+		return id;
+	}
+
+	return MAX_TERMINAL_SYMBOLS;
+}
+
+std::string Forwards::ToString(const SymbolVector& symbols) const {
+	std::ostringstream oss;
+	const char* seperator = "";
+	for (const_iterator ite = begin(); ite != end(); ++ite) {
+		oss << seperator;
+		seperator = "/";
+		oss << symbols[*ite].ToString();
+	}
+
+	return oss.str();
 }
 
 bool LR1Item::operator < (const LR1Item& other) const {
-	if (ptr_->cpos == other.ptr_->cpos) {
-		return ptr_->dpos < other.ptr_->dpos;
+	if (cpos_ == other.cpos_) {
+		return dpos_ < other.dpos_;
 	}
 
-	return ptr_->cpos < other.ptr_->cpos;
+	return cpos_ < other.cpos_;
 }
 
 bool LR1Item::operator ==(const LR1Item& other) const {
-	return ptr_->cpos == other.ptr_->cpos && ptr_->dpos == other.ptr_->dpos;
+	return cpos_ == other.cpos_ && dpos_ == other.dpos_;
 }
 
 std::string LR1Item::ToRawString() const {
-	return Utility::Format("(%d, %d, %d)", Utility::Highword(ptr_->cpos), Utility::Loword(ptr_->cpos), ptr_->dpos);
+	return Utility::Format("(%d, %d, %d)", Utility::Highword(cpos_), Utility::Loword(cpos_), dpos_);
 }
 
-std::string LR1Item::ToString(const GrammarContainer& grammars) const {
+std::string LR1Item::ToString(const Environment& env) const {
 	Grammar* g = nullptr;
-	const Condinate* cond = grammars.GetTargetCondinate(ptr_->cpos, &g);
+	const Condinate* cond = env.grammars.GetTargetCondinate(cpos_, &g);
 
 	std::ostringstream oss;
 	oss << g->GetLhs().ToString() << " : ";
 
 	const char* seperator = "";
 	for (size_t i = 0; i < cond->symbols.size(); ++i) {
-		if (i == ptr_->dpos) {
+		if (i == dpos_) {
 			oss << seperator;
 			seperator = " ";
 			oss << "";
@@ -90,13 +147,10 @@ std::string LR1Item::ToString(const GrammarContainer& grammars) const {
 		seperator = " ";
 	}
 
-	if (ptr_->dpos == (int)cond->symbols.size()) {
+	if (dpos_ == (int)cond->symbols.size()) {
 		oss << seperator << "";
 	}
 
-	oss << ", ";
-	oss << "( " << Utility::Concat(ptr_->forwards.begin(), ptr_->forwards.end(), "/") << " )";
-
 	return oss.str();
 }
 
@@ -105,60 +159,40 @@ LR1Itemset::LR1Itemset() {
 }
 
 bool LR1Itemset::operator < (const LR1Itemset& other) const {
-	const_iterator first1 = begin(), first2 = other.begin();
-	for (; first1 != end() && first2 != other.end(); ++first1, ++first2) {
-		if (!(*first1 == *first2)) {
-			return *first1 < *first2;
-		}
-	}
-
-	if (first1 == end() && first2 == other.end()) {
-		return false;
-	}
-
-	return first1 == end();
+	return std::lexicographical_compare(begin(), end(), other.begin(), other.end());
 }
 
 bool LR1Itemset::operator == (const LR1Itemset& other) const {
-	const_iterator first1 = begin(), first2 = other.begin();
-	for (; first1 != end() && first2 != other.end(); ++first1, ++first2) {
-		if (!(*first1 == *first2)) {
-			return false;
-		}
-	}
-
-	return first1 == end() && first2 == other.end();
+	return size() == other.size() && std::equal(begin(), end(), other.begin());
 }
 
-bool LR1Itemset::insert(const LR1Item& item) {
-	std::pair<iterator, bool> state = ptr_->insert(item);
-	if (state.second) {
-		return true;
-	}
-
-	bool result = false;
-
-	LR1Item& old = (LR1Item&)*state.first;
-	const Forwards& forwards = item.GetForwards();
-	for (Forwards::const_iterator ite = forwards.begin(); ite != forwards.end(); ++ite) {
-		result = old.GetForwards().insert(*ite) || result;
+LR1Itemset::const_iterator LR1Itemset::find(const LR1Item& item) const {
+	const_iterator pos = std::lower_bound(begin(), end(), item);
+	if (pos != end() && *pos == item) {
+		return pos;
 	}
 
-	return result;
+	return end();
 }
 
-const std::string& LR1Itemset::GetName() const {
-	return ptr_->name_;
+int LR1Itemset::IndexOf(const LR1Item& item) const {
+	const_iterator pos = find(item);
+	return (pos != end()) ? int(pos - begin()) : -1;
 }
 
-void LR1Itemset::SetName(const std::string& name) {
-	ptr_->name_ = name;
+bool LR1Itemset::insert(const LR1Item& item) {
+	container_type::iterator pos = std::lower_bound(ptr_->begin(), ptr_->end(), item);
+	if (pos != ptr_->end() && *pos == item) {
+		return false;
+	}
+
+	ptr_->insert(pos, item);
+	return true;
 }
 
-std::string LR1Itemset::ToString(const GrammarContainer& grammars) const {
+std::string LR1Itemset::ToString(const Environment& env) const {
 	std::ostringstream oss;
 
-	oss << "(" << GetName() << ") ";
 	oss << "{ ";
 
 	const char* seperator = "";
@@ -169,7 +203,7 @@ std::string LR1Itemset::ToString(const GrammarContainer& grammars) const {
 
 		oss << seperator;
 		seperator = ", ";
-		oss << "{ " << ite->ToString(grammars) << " }";
+		oss << "{ " << ite->ToString(env) << " }";
 	}
 
 	oss << " }";
@@ -177,57 +211,73 @@ std::string LR1Itemset::ToString(const GrammarContainer& grammars) const {
 	return oss.str();
 }
 
-std::string LR1ItemsetContainer::ToString(const GrammarContainer& grammars) const {
+int ForwardsTable::insert(const Forwards& forwards) {
+	std::pair<std::map<Forwards, int>::iterator, bool> status = ids_.insert(std::make_pair(forwards, (int)container_.size()));
+	if (status.second) {
+		container_.push_back(forwards);
+	}
+
+	return status.first->second;
+}
+
+void ForwardsTable::clear() {
+	container_.clear();
+	ids_.clear();
+}
+
+std::string LR1ItemsetContainer::ToString(const Environment& env) const {
 	std::ostringstream oss;
 	const char* seperator = "";
-	int index = 0;
-	for (const_iterator ite = begin(); ite != end(); ++ite) {
+	for (int i = 0; i < (int)size(); ++i) {
 		oss << seperator;
 		seperator = "\n";
-		oss << ite->ToString(grammars);
+		oss << "(" << i << ") " << at(i).ToString(env);
 	}
 
 	return oss.str();
 }
 
-std::string Propagations::ToString(const GrammarContainer& grammars) const {
-	std::ostringstream oss;
+LR1EdgeTable::LR1EdgeTable() : symbolCount_(0) {
+}
 
-	const char* seperator = "";
-	for (const_iterator ite = begin(); ite != end(); ++ite) {
-		oss << seperator;
-		seperator = "\n";
-		oss << ite->first.ToString(grammars) << " >> ( ";
-		const char* seperator2 = "";
-		for (LR1Itemset::const_iterator ite2 = ite->second.begin();
-			ite2 != ite->second.end(); ++ite2) {
-			oss << seperator2;
-			seperator2 = ", ";
-			oss << ite2->ToString(grammars);
-		}
+void LR1EdgeTable::clear(int symbolCount) {
+	symbolCount_ = symbolCount;
+	container_.clear();
+}
 
-		oss << " )";
+void LR1EdgeTable::insert(int state, int symbol, int target) {
+	if ((int)container_.size() <= state * symbolCount_) {
+		container_.resize((state + 1) * symbolCount_, -1);
 	}
 
-	return oss.str();
+	container_[state * symbolCount_ + symbol] = target;
+}
+
+int LR1EdgeTable::get(int state, int symbol) const {
+	int index = state * symbolCount_ + symbol;
+	return index < (int)container_.size() ? container_[index] : -1;
 }
 
-std::string LR1EdgeTable::ToString(const GrammarContainer& grammars) const {
+std::string LR1EdgeTable::ToString(const Environment& env) const {
 	std::ostringstream oss;
 
 	const char* seperator = "";
-	for (const_iterator ite = begin(); ite != end(); ++ite) {
+	for (int i = 0; i < (int)container_.size(); ++i) {
+		if (container_[i] < 0) {
+			continue;
+		}
+
 		oss << seperator;
 		seperator = "\n";
 
 		oss << "( ";
-		oss << ite->first.first.GetName();
+		oss << i / symbolCount_;
 		oss << ", ";
-		oss << ite->first.second.ToString();
+		oss << env.symbols[i % symbolCount_].ToString();
 		oss << " )";
 
 		oss << " => ";
-		oss << ite->second.GetName();
+		oss << container_[i];
 	}
 
 	return oss.str();
@@ -6,7 +6,7 @@
 #include "lr_table.h"
 #include "grammar_symbol.h"
 
-static const char* actionTexts[] = { "err", "s", "r", "acc" };
+static const char* actionTexts[] = { "err", "s", "r", "acc", "sr" };
 
 bool LRAction::operator == (const LRAction& other) const {
 	return type == other.type && parameter == other.parameter;
@@ -24,7 +24,7 @@ std::string LRAction::ToString(const GrammarContainer& grammars) const {
 	if (type == LRActionShift) {
 		oss << parameter;
 	}
-	else if (type == LRActionReduce) {
+	else if (type == LRActionReduce || type == LRActionShiftReduce) {
 		oss << parameter;
 		/*
 		oss << "(";
@@ -1,5 +1,8 @@
+#include "slr.h"
 #include "lalr.h"
 #include "debug.h"
+#include "pager.h"
+#include "dp_lalr.h"
 #include "action.h"
 #include "matrix.h"
 #include "scanner.h"
@@ -8,9 +11,35 @@
 #include "lr_parser.h"
 #include "syntax_tree.h"
 
-LRParser::LRParser() {
-	impl_ = new LALR;
+LRParser::LRParser(LRImplType type, LRTableEncoding encoding) {
+	switch (type) {
+	case LRImplDPLALR:
+		impl_ = new DPLALR;
+		break;
+
+	case LRImplLazyDPLALR:
+		impl_ = new DPLALR(true);
+		break;
+
+	case LRImplPager:
+		impl_ = new Pager;
+		break;
+
+	case LRImplSLR:
+		impl_ = new SLR;
+		break;
+
+	case LRImplAuto:
+		impl_ = new SLR(true);
+		break;
+
+	default:
+		impl_ = new LALR;
+		break;
+	}
+
 	lrTable_ = new LRTable();
+	lrTable_->SetEncoding(encoding);
 }
 
 LRParser::~LRParser() {
@@ -19,17 +48,25 @@ LRParser::~LRParser() {
 }
 
 bool LRParser::ParseGrammars(Syntaxer& syntaxer, Environment* env) {
-	impl_->Setup(env, &firstSetContainer_);
-
-	if (!impl_->Parse(lrTable_->actionTable_, lrTable_->gotoTable_)) {
+	if (!CreateLRTable(env)) {
 		return false;
 	}
 
+	lrTable_->CreateDefaultReductions();
+	lrTable_->EliminateUnitReductions(env->grammars);
+	lrTable_->CreateShiftReductions(env->grammars);
+	lrTable_->Freeze(env->TerminalCount(), env->NonterminalCount());
+
 	SyntaxerSetupParameter p = { env_, *lrTable_ };
 	syntaxer.Setup(p);
 	return true;
 }
 
+bool LRParser::CreateLRTable(Environment* env) {
+	impl_->Setup(env, &firstSetContainer_, &followSetContainer_, &condinateTable_);
+	return impl_->Parse(lrTable_->actionTable_, lrTable_->gotoTable_);
+}
+
 void LRParser::Clear() {
 	Parser::Clear();
 }
@@ -1,27 +1,378 @@
+#include <map>
+#include <climits>
 #include <sstream>
+#include <algorithm>
 
 #include "lalr.h"
+#include "action.h"
 #include "lr_table.h"
 #include "grammar_symbol.h"
 
-LRTable::LRTable() {
+LRTable::LRTable() : encoding_(LRTableDense), stateCount_(0), terminalCount_(0), nonterminalCount_(0) {
 }
 
 LRTable::~LRTable() {
 }
 
-LRAction LRTable::GetAction(int current, const GrammarSymbol& symbol) {
-	LRAction action = { LRActionError };
-	actionTable_.get(current, symbol, action);
-	return action;
+int LRTable::CountStates() const {
+	int answer = (int)defaults_.size();
+	for (LRActionTable::const_iterator ite = actionTable_.begin(); ite != actionTable_.end(); ++ite) {
+		answer = std::max(answer, ite->first.first + 1);
+
+		// a state shifted to may have no action nor goto, eg, a reduction of program.
+		if (ite->second.type == LRActionShift) {
+			answer = std::max(answer, ite->second.parameter + 1);
+		}
+	}
+
+	for (LRGotoTable::const_iterator ite = gotoTable_.begin(); ite != gotoTable_.end(); ++ite) {
+		answer = std::max(answer, std::max(ite->first.first, ite->second) + 1);
+	}
+
+	return answer;
+}
+
+void LRTable::CreateDefaultReductions() {
+	// count of each (state, cpos) reduction.
+	std::map<std::pair<int, int>, int> counts;
+	for (LRActionTable::const_iterator ite = actionTable_.begin(); ite != actionTable_.end(); ++ite) {
+		if (ite->second.type == LRActionReduce) {
+			++counts[std::make_pair(ite->first.first, ite->second.parameter)];
+		}
+	}
+
+	defaults_.assign(CountStates(), -1);
+
+	// the first of the most frequent ones, ie, the smallest cpos on ties.
+	std::vector<int> maxCounts(defaults_.size(), 0);
+	for (std::map<std::pair<int, int>, int>::const_iterator ite = counts.begin(); ite != counts.end(); ++ite) {
+		int state = ite->first.first;
+		if (ite->second > maxCounts[state]) {
+			maxCounts[state] = ite->second;
+			defaults_[state] = ite->first.second;
+		}
+	}
+
+	LRActionTable actionTable;
+	for (LRActionTable::const_iterator ite = actionTable_.begin(); ite != actionTable_.end(); ++ite) {
+		if (ite->second.type != LRActionReduce || ite->second.parameter != defaults_[ite->first.first]) {
+			actionTable.insert(ite->first.first, ite->first.second, ite->second);
+		}
+	}
+
+	Debug::Log(Utility::Format("%d of %d action entries folded into default reductions.",
+		actionTable_.size() - actionTable.size(), actionTable_.size()));
+
+	actionTable_ = actionTable;
+}
+
+void LRTable::FindLR0Reductions(std::vector<int>& answer) const {
+	answer = defaults_;
+	for (LRActionTable::const_iterator ite = actionTable_.begin(); ite != actionTable_.end(); ++ite) {
+		answer[ite->first.first] = -1;
+	}
+}
+
+void LRTable::EliminateUnitReductions(const GrammarContainer& grammars) {
+	std::vector<int> reductions;
+	FindLR0Reductions(reductions);
+
+	// grammar of the unit reduction of each state, nullptr if the state does anything else.
+	std::vector<Grammar*> units(defaults_.size(), nullptr);
+	for (int i = 0; i < (int)defaults_.size(); ++i) {
+		if (reductions[i] < 0) {
+			continue;
+		}
+
+		Grammar* g = nullptr;
+		const Condinate* cond = grammars.GetTargetCondinate(reductions[i], &g);
+		if (cond->symbols.size() == 1 && cond->symbols.front().SymbolType() == GrammarSymbolNonterminal
+			&& cond->action != nullptr && cond->action->IsIdentity()) {
+			units[i] = g;
+		}
+	}
+
+	// the reduction pops the unit state only, so the goto on its lhs is taken from the same state.
+	int count = 0;
+	LRGotoTable gotoTable;
+	for (LRGotoTable::const_iterator ite = gotoTable_.begin(); ite != gotoTable_.end(); ++ite) {
+		int target = ite->second;
+		for (int i = 0; units[target] != nullptr && i < (int)units.size(); ++i) {
+			bool found = gotoTable_.get(ite->first.first, units[target]->GetLhs(), target);
+			Assert(found, "can not find goto of " + units[target]->GetLhs().ToString());
+		}
+
+		count += (target != ite->second) ? 1 : 0;
+		gotoTable.insert(ite->first.first, ite->first.second, target);
+	}
+
+	Debug::Log(Utility::Format("%d of %d gotos skip unit reductions.", count, gotoTable_.size()));
+
+	gotoTable_ = gotoTable;
 }
 
-int LRTable::GetGoto(int current, const GrammarSymbol& symbol) {
-	int answer = -1;
-	gotoTable_.get(current, symbol, answer);
+void LRTable::CreateShiftReductions(const GrammarContainer& grammars) {
+	std::vector<int> reductions;
+	FindLR0Reductions(reductions);
+
+	int count = 0, shifts = 0;
+	LRActionTable actionTable;
+	for (LRActionTable::const_iterator ite = actionTable_.begin(); ite != actionTable_.end(); ++ite) {
+		LRAction action = ite->second;
+		shifts += (action.type == LRActionShift) ? 1 : 0;
+
+		int cpos = (action.type == LRActionShift) ? reductions[action.parameter] : -1;
+		if (cpos >= 0) {
+			// only a reduction popping the state shifted to can be done at once,
+			// ie, its condinate is not empty and ends with the symbol shifted.
+			const SymbolVector& symbols = grammars.GetTargetCondinate(cpos, nullptr)->symbols;
+			if (symbols.front() != NativeSymbols::epsilon && symbols.back() == ite->first.second) {
+				action.type = LRActionShiftReduce;
+				action.parameter = cpos;
+				++count;
+			}
+		}
+
+		actionTable.insert(ite->first.first, ite->first.second, action);
+	}
+
+	Debug::Log(Utility::Format("%d of %d shifts reduce at once.", count, shifts));
+
+	actionTable_ = actionTable;
+}
+
+void LRTable::SetEncoding(LRTableEncoding encoding) {
+	encoding_ = encoding;
+}
+
+void LRTable::Freeze(int terminalCount, int nonterminalCount) {
+	stateCount_ = CountStates();
+	defaults_.resize(stateCount_, -1);
+
+	terminalCount_ = terminalCount;
+	nonterminalCount_ = nonterminalCount;
+
+	FindLR0Reductions(lr0Reductions_);
+
+	if (encoding_ == LRTablePacked) {
+		CreatePackedTables();
+	}
+	else {
+		CreateDenseTables();
+	}
+}
+
+void LRTable::CreateDenseTables() {
+	actionBases_.clear();
+	gotoBases_.clear();
+	defaultGotos_.clear();
+	next_.clear();
+	check_.clear();
+
+	LRAction error = { LRActionError };
+	actions_.assign(stateCount_ * terminalCount_, error);
+	gotos_.assign(stateCount_ * nonterminalCount_, -1);
+
+	for (LRActionTable::const_iterator ite = actionTable_.begin(); ite != actionTable_.end(); ++ite) {
+		int id = ite->first.second.GetID();
+		Assert(id >= 0 && id < terminalCount_, "invalid terminal symbol " + ite->first.second.ToString());
+		actions_[ite->first.first * terminalCount_ + id] = ite->second;
+	}
+
+	for (LRGotoTable::const_iterator ite = gotoTable_.begin(); ite != gotoTable_.end(); ++ite) {
+		int id = ite->first.second.GetID() - terminalCount_;
+		Assert(id >= 0 && id < nonterminalCount_, "invalid non-terminal symbol " + ite->first.second.ToString());
+		gotos_[ite->first.first * nonterminalCount_ + id] = ite->second;
+	}
+
+	// errors of a state with a default reduction reduce instead, the error is found before the next shift.
+	for (int i = 0; i < stateCount_; ++i) {
+		if (defaults_[i] < 0) {
+			continue;
+		}
+
+		LRAction reduce = { LRActionReduce, defaults_[i] };
+		for (int j = i * terminalCount_; j < (i + 1) * terminalCount_; ++j) {
+			if (actions_[j].type == LRActionError) {
+				actions_[j] = reduce;
+			}
+		}
+	}
+}
+
+void LRTable::CreatePackedTables() {
+	actions_.clear();
+	gotos_.clear();
+
+	// action rows of the states, then goto columns of the nonterminals.
+	std::vector<PackedVector> vectors(stateCount_ + nonterminalCount_);
+	for (LRActionTable::const_iterator ite = actionTable_.begin(); ite != actionTable_.end(); ++ite) {
+		int id = ite->first.second.GetID();
+		Assert(id >= 0 && id < terminalCount_, "invalid terminal symbol " + ite->first.second.ToString());
+		vectors[ite->first.first].push_back(std::make_pair(id, ite->second));
+	}
+
+	// the default goto of a nonterminal is its most frequent target, the smallest one on ties.
+	std::vector<std::map<int, int> > counts(nonterminalCount_);
+	for (LRGotoTable::const_iterator ite = gotoTable_.begin(); ite != gotoTable_.end(); ++ite) {
+		int id = ite->first.second.GetID() - terminalCount_;
+		Assert(id >= 0 && id < nonterminalCount_, "invalid non-terminal symbol " + ite->first.second.ToString());
+		++counts[id][ite->second];
+	}
+
+	defaultGotos_.assign(nonterminalCount_, -1);
+	for (int i = 0; i < nonterminalCount_; ++i) {
+		int maxCount = 0;
+		for (std::map<int, int>::const_iterator ite = counts[i].begin(); ite != counts[i].end(); ++ite) {
+			if (ite->second > maxCount) {
+				maxCount = ite->second;
+				defaultGotos_[i] = ite->first;
+			}
+		}
+	}
+
+	// gotoTable_ is ordered by state, so is each column.
+	int defaultCount = 0;
+	for (LRGotoTable::const_iterator ite = gotoTable_.begin(); ite != gotoTable_.end(); ++ite) {
+		int id = ite->first.second.GetID() - terminalCount_;
+		if (ite->second != defaultGotos_[id]) {
+			LRAction entry = { LRActionShift, ite->second };
+			vectors[stateCount_ + id].push_back(std::make_pair(ite->first.first, entry));
+		}
+		else {
+			++defaultCount;
+		}
+	}
+
+	// the largest vectors first, they are the hardest to fit.
+	std::vector<std::pair<int, int> > order;
+	for (int i = 0; i < (int)vectors.size(); ++i) {
+		order.push_back(std::make_pair(-(int)vectors[i].size(), i));
+	}
+
+	std::sort(order.begin(), order.end());
+
+	next_.clear();
+	check_.clear();
+
+	std::set<int> bases;
+	std::vector<int> positions(vectors.size());
+	int firstFree = 0;
+	for (std::vector<std::pair<int, int> >::const_iterator ite = order.begin(); ite != order.end(); ++ite) {
+		positions[ite->second] = PackVector(vectors[ite->second], bases, firstFree);
+	}
+
+	actionBases_.assign(positions.begin(), positions.begin() + stateCount_);
+	gotoBases_.assign(positions.begin() + stateCount_, positions.end());
+
+	Debug::Log(Utility::Format("packed %d action and %d goto entries into %d slots.",
+		actionTable_.size(), gotoTable_.size() - defaultCount, (int)next_.size()));
+}
+
+int LRTable::PackVector(const PackedVector& vector, std::set<int>& bases, int& firstFree) {
+	// no index of a vector without entries is ever in the table.
+	if (vector.empty()) {
+		return INT_MIN / 2;
+	}
+
+	int base = firstFree - vector.front().first;
+	for (;; ++base) {
+		if (bases.find(base) != bases.end()) {
+			continue;
+		}
+
+		PackedVector::const_iterator ite = vector.begin();
+		for (; ite != vector.end(); ++ite) {
+			int i = base + ite->first;
+			if (i < 0 || (i < (int)check_.size() && check_[i] >= 0)) {
+				break;
+			}
+		}
+
+		if (ite == vector.end()) {
+			break;
+		}
+	}
+
+	LRAction error = { LRActionError };
+	for (PackedVector::const_iterator ite = vector.begin(); ite != vector.end(); ++ite) {
+		int i = base + ite->first;
+		if (i >= (int)check_.size()) {
+			next_.resize(i + 1, error);
+			check_.resize(i + 1, -1);
+		}
+
+		next_[i] = ite->second;
+		check_[i] = ite->first;
+	}
+
+	bases.insert(base);
+	for (; firstFree < (int)check_.size() && check_[firstFree] >= 0; ++firstFree) {
+	}
+
+	return base;
+}
+
+void LRTable::Compact() {
+	gotoTable_.clear();
+	actionTable_.clear();
+}
+
+size_t LRTable::GetRetainedBytes() const {
+	return sizeof(LRTable) + actions_.capacity() * sizeof(LRAction) + gotos_.capacity() * sizeof(int)
+		+ (defaults_.capacity() + lr0Reductions_.capacity()) * sizeof(int)
+		+ (actionBases_.capacity() + gotoBases_.capacity() + defaultGotos_.capacity() + check_.capacity()) * sizeof(int)
+		+ next_.capacity() * sizeof(LRAction);
+}
+
+size_t LRTable::GetSparseBytes() const {
+	return actionTable_.size() * Utility::TreeNodeSize(sizeof(LRActionTable::container_type::value_type))
+		+ gotoTable_.size() * Utility::TreeNodeSize(sizeof(LRGotoTable::container_type::value_type));
+}
+
+LRAction LRTable::GetAction(int current, const GrammarSymbol& symbol) const {
+	Assert(current >= 0 && current < stateCount_, "invalid state " + std::to_string(current));
+	int id = symbol.GetID();
+	Assert(id >= 0 && id < terminalCount_, "invalid terminal symbol " + symbol.ToString());
+	if (encoding_ == LRTableDense) {
+		return actions_[current * terminalCount_ + id];
+	}
+
+	int i = actionBases_[current] + id;
+	if (i >= 0 && i < (int)check_.size() && check_[i] == id) {
+		return next_[i];
+	}
+
+	LRAction answer = { LRActionError };
+	if (defaults_[current] >= 0) {
+		answer.type = LRActionReduce;
+		answer.parameter = defaults_[current];
+	}
+
 	return answer;
 }
 
+int LRTable::GetLR0Reduction(int current) const {
+	Assert(current >= 0 && current < stateCount_, "invalid state " + std::to_string(current));
+	return lr0Reductions_[current];
+}
+
+int LRTable::GetGoto(int current, const GrammarSymbol& symbol) const {
+	Assert(current >= 0 && current < stateCount_, "invalid state " + std::to_string(current));
+	int id = symbol.GetID() - terminalCount_;
+	Assert(id >= 0 && id < nonterminalCount_, "invalid non-terminal symbol " + symbol.ToString());
+	if (encoding_ == LRTableDense) {
+		return gotos_[current * nonterminalCount_ + id];
+	}
+
+	int i = gotoBases_[id] + current;
+	if (i >= 0 && i < (int)check_.size() && check_[i] == current) {
+		return next_[i].parameter;
+	}
+
+	return defaultGotos_[id];
+}
+
 std::string LRTable::ToString(const GrammarContainer& grammars) const {
 	std::ostringstream oss;
 	
@@ -33,5 +384,16 @@ std::string LRTable::ToString(const GrammarContainer& grammars) const {
 	oss << Utility::Heading(" Goto Table ") << "\n";
 	oss << gotoTable_.ToString();
 
+	oss << "\n\n";
+
+	oss << Utility::Heading(" Default Reductions ") << "\n";
+	const char* seperator = "";
+	for (int i = 0; i < (int)defaults_.size(); ++i) {
+		if (defaults_[i] >= 0) {
+			oss << seperator << "(" << i << ") => (r" << defaults_[i] << ")";
+			seperator = "\n";
+		}
+	}
+
 	return oss.str();
 }
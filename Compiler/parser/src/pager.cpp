@@ -0,0 +1,235 @@
+#include <map>
+#include <algorithm>
+
+#include "debug.h"
+#include "pager.h"
+#include "grammar.h"
+
+Pager::Pager() {
+}
+
+Pager::~Pager() {
+}
+
+bool Pager::Parse(LRActionTable& actionTable, LRGotoTable& gotoTable) {
+	symbolCount_ = (int)env_->symbols.size();
+
+	Debug::StartSample("create LR1 states");
+	CreateLR1States();
+	Debug::EndSample();
+
+	CopyReachableStates();
+	InternForwards();
+
+	Debug::Log(Utility::Format("Pager: %d LR(1) states, %d reachable, %d kernels.",
+		(int)lr1States_.size(), (int)states_.size(), (int)kernels_.size()));
+
+	lr1States_.clear();
+	kernels_.clear();
+	arena_.Release();
+
+	Debug::StartSample("create parsing table");
+	bool status = CreateLRParsingTable(gotoTable, actionTable);
+	Debug::EndSample();
+
+	return status;
+}
+
+void Pager::CreateLR1States() {
+	lr1States_.clear();
+	lr1Edges_.clear(symbolCount_);
+	kernels_.clear();
+	queued_.clear();
+
+	Forwards zero;
+	zero.insert(NativeSymbols::zero);
+
+	LR0::Kernel kernel(&arena_);
+	ForwardsVector forwards;
+	const GrammarSymbol& program = env_->grammars.front()->GetLhs();
+	int last = condinates_->GetLastCondinate(program);
+	for (int id = condinates_->GetFirstCondinate(program); id < last; ++id) {
+		// the items after a nullable prefix are in the kernel of LR0 too,
+		// but only the whole condinate of program is followed by $.
+		for (int dpos = 0; dpos <= condinates_->GetClosureEnd(id); ++dpos) {
+			kernel.push_back(condinates_->GetCpos(id));
+			kernel.push_back(dpos);
+			forwards.push_back((dpos == 0) ? zero : Forwards());
+		}
+	}
+
+	AddState(kernel, forwards);
+
+	// a state is expanded again whenever a merge adds to its forwards.
+	for (; !queue_.empty(); queue_.pop()) {
+		queued_[queue_.front()] = false;
+		ExpandState(queue_.front());
+	}
+}
+
+void Pager::ExpandState(int state) {
+	LR1Itemset itemset;
+	ForwardsVector closure;
+	CalculateLR1Closure(state, itemset, closure);
+
+	// kernels and forwards of the successors, by symbol id.
+	std::map<int, std::pair<LR0::Kernel, ForwardsVector> > successors;
+	for (int i = 0; i < itemset.size(); ++i) {
+		const LR1Item& item = itemset[i];
+		const Condinate* cond = env_->grammars.GetTargetCondinate(item.GetCpos(), nullptr);
+
+		if (cond->symbols.front() == NativeSymbols::epsilon || item.GetDpos() >= (int)cond->symbols.size()) {
+			continue;
+		}
+
+		const GrammarSymbol& symbol = cond->symbols[item.GetDpos()];
+		if (symbol == env_->program) {
+			continue;
+		}
+
+		std::pair<LR0::Kernel, ForwardsVector>& successor = successors.insert(
+			std::make_pair(symbol.GetID(), std::make_pair(LR0::Kernel(&arena_), ForwardsVector()))).first->second;
+		successor.first.push_back(item.GetCpos());
+		successor.first.push_back(item.GetDpos() + 1);
+		successor.second.push_back(closure[i]);
+	}
+
+	for (std::map<int, std::pair<LR0::Kernel, ForwardsVector> >::iterator ite = successors.begin(); ite != successors.end(); ++ite) {
+		lr1Edges_.insert(state, ite->first, AddState(ite->second.first, ite->second.second));
+	}
+}
+
+int Pager::AddState(const LR0::Kernel& kernel, const ForwardsVector& forwards) {
+	std::vector<int>& candidates = kernels_[kernel];
+	for (std::vector<int>::const_iterator ite = candidates.begin(); ite != candidates.end(); ++ite) {
+		ForwardsVector& other = lr1States_[*ite].forwards;
+		if (!IsWeaklyCompatible(other, forwards)) {
+			continue;
+		}
+
+		bool changed = false;
+		for (int i = 0; i < (int)other.size(); ++i) {
+			changed = other[i].merge(forwards[i]) || changed;
+		}
+
+		if (changed) {
+			Enqueue(*ite);
+		}
+
+		return *ite;
+	}
+
+	State state = { kernel, forwards };
+	lr1States_.push_back(state);
+	candidates.push_back((int)lr1States_.size() - 1);
+
+	Enqueue(candidates.back());
+	return candidates.back();
+}
+
+void Pager::Enqueue(int state) {
+	if ((int)queued_.size() <= state) {
+		queued_.resize(state + 1, false);
+	}
+
+	if (!queued_[state]) {
+		queued_[state] = true;
+		queue_.push(state);
+	}
+}
+
+bool Pager::IsWeaklyCompatible(const ForwardsVector& x, const ForwardsVector& y) const {
+	// for each pair of items, merging must not join forwards that are disjoint in both states,
+	// unless one state already has them in common.
+	for (int i = 0; i < (int)x.size(); ++i) {
+		for (int j = i + 1; j < (int)x.size(); ++j) {
+			if (x[i].intersects(x[j]) || y[i].intersects(y[j])) {
+				continue;
+			}
+
+			if (x[i].intersects(y[j]) || y[i].intersects(x[j])) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+void Pager::CalculateLR1Closure(int state, LR1Itemset& itemset, ForwardsVector& closure) const {
+	const State& src = lr1States_[state];
+
+	LR1Itemset kernel;
+	for (LR0::Kernel::const_iterator ite = src.kernel.begin(); ite != src.kernel.end(); ite += 2) {
+		kernel.insert(LR1Item(ite[0], ite[1]));
+	}
+
+	condinates_->CalculateClosure(kernel, itemset);
+
+	closure.assign(itemset.size(), Forwards());
+	for (int i = 0; i < kernel.size(); ++i) {
+		closure[itemset.IndexOf(kernel[i])] = src.forwards[i];
+	}
+
+	CalculateClosure(itemset, closure);
+}
+
+void Pager::CopyReachableStates() {
+	// reachable states are numbered in BFS order, following symbols by id.
+	std::vector<int> numbers(lr1States_.size(), -1);
+	std::vector<int> order(1, 0);
+	numbers[0] = 0;
+
+	for (int i = 0; i < (int)order.size(); ++i) {
+		for (int id = 0; id < symbolCount_; ++id) {
+			int target = lr1Edges_.get(order[i], id);
+			if (target >= 0 && numbers[target] < 0) {
+				numbers[target] = (int)order.size();
+				order.push_back(target);
+			}
+		}
+	}
+
+	edges_.clear(symbolCount_);
+	states_.clear();
+
+	// the kernel and the reductions are kept, as LR0 does.
+	std::vector<ForwardsVector> forwards(order.size());
+	for (int i = 0; i < (int)order.size(); ++i) {
+		for (int id = 0; id < symbolCount_; ++id) {
+			int target = lr1Edges_.get(order[i], id);
+			if (target >= 0) {
+				edges_.insert(i, id, numbers[target]);
+			}
+		}
+
+		LR1Itemset itemset;
+		ForwardsVector closure;
+		CalculateLR1Closure(order[i], itemset, closure);
+
+		LR1Itemset kept;
+		const LR0::Kernel& kernel = lr1States_[order[i]].kernel;
+		for (LR0::Kernel::const_iterator ite = kernel.begin(); ite != kernel.end(); ite += 2) {
+			kept.insert(LR1Item(ite[0], ite[1]));
+		}
+
+		for (int j = 0; j < itemset.size(); ++j) {
+			if (condinates_->IsReduction(itemset[j].GetCpos(), itemset[j].GetDpos())) {
+				kept.insert(itemset[j]);
+			}
+		}
+
+		for (int j = 0; j < kept.size(); ++j) {
+			forwards[i].push_back(closure[itemset.IndexOf(kept[j])]);
+		}
+
+		states_.push_back(kept);
+	}
+
+	CreateItemIDs();
+	for (int i = 0; i < (int)states_.size(); ++i) {
+		std::copy(forwards[i].begin(), forwards[i].end(), forwards_.begin() + itemIDs_[i]);
+	}
+
+	lr1Edges_.clear(symbolCount_);
+}
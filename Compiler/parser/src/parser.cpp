@@ -2,11 +2,13 @@
 
 #include "debug.h"
 #include "table.h"
+#include "define.h"
 #include "reader.h"
 #include "parser.h"
 #include "action.h"
 #include "scanner.h"
 #include "serializer.h"
+#include "digraph.h"
 
 bool Environment::Load(std::ifstream& file) {
 	return Serializer::LoadEnvironment(file, this);
@@ -16,6 +18,56 @@ bool Environment::Save(std::ofstream& file) {
 	return Serializer::SaveEnvironment(file, this);
 }
 
+void Environment::AddNativeSymbols() {
+	NativeSymbols::Copy(terminalSymbols);
+
+	program = SymbolFactory::Create(NativeSymbols::programText);
+	nonterminalSymbols.insert(std::make_pair(program.ToString(), program));
+}
+
+void Environment::NumberSymbols() {
+	symbols.clear();
+	NativeSymbols::CopyTerminals(symbols);
+
+	for (GrammarSymbolContainer::iterator ite = terminalSymbols.begin(); ite != terminalSymbols.end(); ++ite) {
+		if (!NativeSymbols::IsNative(ite->second)) {
+			ite->second.SetID(symbols.size());
+			symbols.push_back(ite->second);
+		}
+	}
+
+	Assert(TerminalCount() <= MAX_TERMINAL_SYMBOLS, "too many terminal symbols.");
+
+	for (GrammarSymbolContainer::iterator ite = nonterminalSymbols.begin(); ite != nonterminalSymbols.end(); ++ite) {
+		ite->second.SetID(symbols.size());
+		symbols.push_back(ite->second);
+	}
+}
+
+int Environment::TerminalCount() const {
+	return terminalSymbols.size() + 1;
+}
+
+int Environment::NonterminalCount() const {
+	return nonterminalSymbols.size();
+}
+
+size_t Environment::GetRetainedBytes() const {
+	size_t answer = sizeof(Environment) + symbols.capacity() * sizeof(GrammarSymbol);
+	answer += (terminalSymbols.size() + nonterminalSymbols.size()) * Utility::TreeNodeSize(sizeof(GrammarSymbolContainer::value_type));
+
+	answer += grammars.capacity() * sizeof(Grammar*);
+	for (GrammarContainer::const_iterator ite = grammars.begin(); ite != grammars.end(); ++ite) {
+		const CondinateContainer& conds = (*ite)->GetCondinates();
+		answer += sizeof(Grammar) + conds.capacity() * sizeof(Condinate*);
+		for (CondinateContainer::const_iterator ite2 = conds.begin(); ite2 != conds.end(); ++ite2) {
+			answer += sizeof(Condinate) + (*ite2)->symbols.capacity() * sizeof(GrammarSymbol);
+		}
+	}
+
+	return answer;
+}
+
 Environment::~Environment() {
 	for (GrammarContainer::iterator ite = grammars.begin(); ite != grammars.end(); ++ite) {
 		delete *ite;
@@ -31,104 +83,135 @@ Parser::~Parser() {
 bool Parser::Setup(Syntaxer& syntaxer, Environment* env) {
 	env_ = env;
 	CreateFirstSets();
+	condinateTable_.Setup(env_, &firstSetContainer_);
 	CreateFollowSets();
 
 	return ParseGrammars(syntaxer, env);
 }
 
-bool Parser::MergeNonEpsilonElements(GrammarSymbolSet& dest, const GrammarSymbolSet& src) {
-	bool modified = false;
-	for (GrammarSymbolSet::const_iterator ite = src.begin(); ite != src.end(); ++ite) {
-		if (*ite != NativeSymbols::epsilon) {
-			modified = dest.insert(*ite).second || modified;
-		}
-	}
-
-	return modified;
-}
-
-
 void Parser::Clear() {
 }
 
 void Parser::CreateFirstSets() {
-	for (GrammarSymbolContainer::const_iterator ite = env_->terminalSymbols.begin(); ite != env_->terminalSymbols.end(); ++ite) {
-		firstSetContainer_[ite->second].insert(ite->second);
-	}
+	std::vector<bool> nullables;
+	CreateNullables(nullables);
+
+	// FIRST(A) contains FIRST(X) for A : alpha X beta, where alpha is nullable.
+	Digraph::Relation relation(env_->symbols.size());
+	Digraph::ForwardsVector firstSets(env_->symbols.size());
+
+	for (GrammarContainer::const_iterator ite = env_->grammars.begin(); ite != env_->grammars.end(); ++ite) {
+		int lhs = (*ite)->GetLhs().GetID();
+		const CondinateContainer& conds = (*ite)->GetCondinates();
 
-	for (; CreateFirstSetsOnePass();) {
+		for (CondinateContainer::const_iterator ite2 = conds.begin(); ite2 != conds.end(); ++ite2) {
+			const SymbolVector& symbols = (*ite2)->symbols;
+			for (SymbolVector::const_iterator ite3 = symbols.begin(); ite3 != symbols.end(); ++ite3) {
+				if (ite3->SymbolType() == GrammarSymbolNonterminal) {
+					relation[lhs].push_back(ite3->GetID());
+				}
+				else if (*ite3 != NativeSymbols::epsilon) {
+					firstSets[lhs].insert(*ite3);
+				}
+
+				if (!nullables[ite3->GetID()]) {
+					break;
+				}
+			}
+		}
 	}
-}
 
-bool Parser::CreateFirstSetsOnePass() {
-	bool anySetModified = false;
+	Digraph::Solve(relation, firstSets);
+
+	for (GrammarSymbolContainer::const_iterator ite = env_->terminalSymbols.begin(); ite != env_->terminalSymbols.end(); ++ite) {
+		firstSetContainer_[ite->second].insert(ite->second);
+	}
 
 	for (GrammarContainer::const_iterator ite = env_->grammars.begin(); ite != env_->grammars.end(); ++ite) {
-		Grammar* g = *ite;
-		const CondinateContainer& conds = g->GetCondinates();
-		GrammarSymbolSet& firstSet = firstSetContainer_[g->GetLhs()];
+		const GrammarSymbol& lhs = (*ite)->GetLhs();
+		GrammarSymbolSet& firstSet = firstSetContainer_[lhs];
+		CopyForwards(firstSet, firstSets[lhs.GetID()]);
 
-		for (CondinateContainer::const_iterator ite2 = conds.begin(); ite2 != conds.end(); ++ite2) {
-			Condinate* c = *ite2;
-			SymbolVector::iterator ite3 = c->symbols.begin();
+		if (nullables[lhs.GetID()]) {
+			firstSet.insert(NativeSymbols::epsilon);
+		}
+	}
+}
 
-			for (; ite3 != c->symbols.end(); ++ite3) {
-				GrammarSymbol& current = *ite3;
+void Parser::CreateNullables(std::vector<bool>& nullables) {
+	nullables.assign(env_->symbols.size(), false);
+	nullables[NativeSymbols::epsilon.GetID()] = true;
 
-				anySetModified = MergeNonEpsilonElements(firstSet, firstSetContainer_[current]) || anySetModified;
+	for (bool changed = true; changed;) {
+		changed = false;
+		for (GrammarContainer::const_iterator ite = env_->grammars.begin(); ite != env_->grammars.end(); ++ite) {
+			int lhs = (*ite)->GetLhs().GetID();
+			if (nullables[lhs]) {
+				continue;
+			}
 
-				GrammarSymbolSet& currentFirstSet = firstSetContainer_[current];
-				if (currentFirstSet.find(NativeSymbols::epsilon) == currentFirstSet.end()) {
-					break;
+			const CondinateContainer& conds = (*ite)->GetCondinates();
+			for (CondinateContainer::const_iterator ite2 = conds.begin(); ite2 != conds.end() && !nullables[lhs]; ++ite2) {
+				const SymbolVector& symbols = (*ite2)->symbols;
+				SymbolVector::const_iterator ite3 = symbols.begin();
+				for (; ite3 != symbols.end() && nullables[ite3->GetID()]; ++ite3) {
 				}
-			}
 
-			if (ite3 == c->symbols.end()) {
-				anySetModified = firstSet.insert(NativeSymbols::epsilon).second || anySetModified;
+				if (ite3 == symbols.end()) {
+					nullables[lhs] = true;
+					changed = true;
+				}
 			}
 		}
 	}
-
-	return anySetModified;
 }
 
 void Parser::CreateFollowSets() {
-	followSetContainer_[env_->grammars.front()->GetLhs()].insert(NativeSymbols::zero);
+	// FOLLOW(X) contains FOLLOW(A) for A : alpha X beta, where beta is nullable.
+	Digraph::Relation relation(env_->symbols.size());
+	Digraph::ForwardsVector followSets(env_->symbols.size());
 
-	for (; CreateFollowSetsOnePass();) {
-	}
-}
+	followSets[env_->grammars.front()->GetLhs().GetID()].insert(NativeSymbols::zero);
 
-bool Parser::CreateFollowSetsOnePass() {
-	bool anySetModified = false;
+	int gi = 0;
+	for (GrammarContainer::const_iterator ite = env_->grammars.begin(); ite != env_->grammars.end(); ++ite, ++gi) {
+		int lhs = (*ite)->GetLhs().GetID();
+		const CondinateContainer& conds = (*ite)->GetCondinates();
 
-	GrammarSymbolSet gss;
-	for (GrammarContainer::const_iterator ite = env_->grammars.begin(); ite != env_->grammars.end(); ++ite) {
-		Grammar* g = *ite;
-		const CondinateContainer& conds = g->GetCondinates();
+		int ci = 0;
+		for (CondinateContainer::const_iterator ite2 = conds.begin(); ite2 != conds.end(); ++ite2, ++ci) {
+			const SymbolVector& symbols = (*ite2)->symbols;
+			int cpos = Utility::MakeDword(ci, gi);
 
-		for (CondinateContainer::const_iterator ite2 = conds.begin(); ite2 != conds.end(); ++ite2) {
-			Condinate* current = *ite2;
-			for (SymbolVector::iterator ite3 = current->symbols.begin(); ite3 != current->symbols.end(); ++ite3) {
-				GrammarSymbol& symbol = *ite3;
-				if (symbol.SymbolType() == GrammarSymbolTerminal) {
+			for (int i = 0; i < (int)symbols.size(); ++i) {
+				if (symbols[i].SymbolType() == GrammarSymbolTerminal) {
 					continue;
 				}
 
-				SymbolVector::iterator ite4 = ite3;
-				firstSetContainer_.GetFirstSet(gss, ++ite4, current->symbols.end());
-				anySetModified = MergeNonEpsilonElements(followSetContainer_[symbol], gss) || anySetModified;
+				int id = symbols[i].GetID();
+				followSets[id].merge(condinateTable_.GetFirstSet(cpos, i + 1));
 
-				if (gss.find(NativeSymbols::epsilon) != gss.end()) {
-					anySetModified = MergeNonEpsilonElements(followSetContainer_[symbol], followSetContainer_[g->GetLhs()]) || anySetModified;
+				if (condinateTable_.IsNullableSuffix(cpos, i + 1)) {
+					relation[id].push_back(lhs);
 				}
-
-				gss.clear();
 			}
 		}
 	}
 
-	return anySetModified;
+	Digraph::Solve(relation, followSets);
+
+	for (GrammarSymbolContainer::const_iterator ite = env_->nonterminalSymbols.begin(); ite != env_->nonterminalSymbols.end(); ++ite) {
+		const Forwards& followSet = followSets[ite->second.GetID()];
+		if (!followSet.empty()) {
+			CopyForwards(followSetContainer_[ite->second], followSet);
+		}
+	}
+}
+
+void Parser::CopyForwards(GrammarSymbolSet& answer, const Forwards& forwards) {
+	for (Forwards::const_iterator ite = forwards.begin(); ite != forwards.end(); ++ite) {
+		answer.insert(env_->symbols[*ite]);
+	}
 }
 
 std::string Parser::ToString() const {
@@ -43,7 +43,8 @@ bool Serializer::LoadEnvironment(std::ifstream& file, Environment* env) {
 		return false;
 	}
 
-	NativeSymbols::Copy(env->terminalSymbols, env->nonterminalSymbols);
+	env->AddNativeSymbols();
+	env->NumberSymbols();
 
 	if (!LoadGrammars(file, env->terminalSymbols, env->nonterminalSymbols, env->grammars)) {
 		Debug::LogError("failed to save grammars.");
@@ -68,6 +69,7 @@ bool Serializer::LoadSyntaxer(std::ifstream& file, SyntaxerSetupParameter& p) {
 		return false;
 	}
 
+	p.lrTable.Freeze(p.env->TerminalCount(), p.env->NonterminalCount());
 	return true;
 }
 
@@ -182,7 +184,15 @@ bool Serializer::SaveLRTable(std::ofstream& file, const LRTable& table) {
 		return false;
 	}
 
-	return SaveLRGotoTable(file, table.gotoTable_);
+	if (!SaveLRGotoTable(file, table.gotoTable_)) {
+		return false;
+	}
+
+	if (!WriteIntegers(file, table.defaults_)) {
+		return false;
+	}
+
+	return WriteInteger(file, table.encoding_);
 }
 
 bool Serializer::LoadLRTable(std::ifstream& file, GrammarSymbolContainer& terminalSymbols, GrammarSymbolContainer& nonterminalSymbols, LRTable& table) {
@@ -190,7 +200,21 @@ bool Serializer::LoadLRTable(std::ifstream& file, GrammarSymbolContainer& termin
 		return false;
 	}
 
-	return LoadLRGotoTable(file, nonterminalSymbols, table);
+	if (!LoadLRGotoTable(file, nonterminalSymbols, table)) {
+		return false;
+	}
+
+	if (!ReadIntegers(file, table.defaults_)) {
+		return false;
+	}
+
+	int encoding = LRTableDense;
+	if (!ReadInteger(file, encoding)) {
+		return false;
+	}
+
+	table.SetEncoding((LRTableEncoding)encoding);
+	return true;
 }
 
 bool Serializer::LoadCondinates(GrammarSymbolContainer& terminalSymbols, GrammarSymbolContainer& nonterminalSymbols, std::ifstream& file, Grammar* grammar) {
@@ -305,6 +329,8 @@ bool Serializer::LoadLRActionTable(std::ifstream& file, GrammarSymbolContainer&
 			return false;
 		}
 
+		Assert(actionType >= LRActionError && actionType <= LRActionShiftReduce, "invalid action type " + std::to_string(actionType));
+
 		LRAction action = { (LRActionType)actionType, actionParameter };
 		table.actionTable_.insert(from, symbol, action);
 	}
@@ -352,6 +378,36 @@ bool Serializer::WriteString(std::ofstream& file, const std::string& str) {
 	return file.write((char*)&count, sizeof(count)) && file.write(str.c_str(), count);
 }
 
+bool Serializer::WriteIntegers(std::ofstream& file, const std::vector<int>& integers) {
+	if (!WriteInteger(file, (int)integers.size())) {
+		return false;
+	}
+
+	for (std::vector<int>::const_iterator ite = integers.begin(); ite != integers.end(); ++ite) {
+		if (!WriteInteger(file, *ite)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool Serializer::ReadIntegers(std::ifstream& file, std::vector<int>& integers) {
+	int count = 0;
+	if (!ReadInteger(file, count)) {
+		return false;
+	}
+
+	integers.resize(count);
+	for (int i = 0; i < count; ++i) {
+		if (!ReadInteger(file, integers[i])) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
 bool Serializer::ReadInteger(std::ifstream& file, int& integer) {
 	if (!file.read(intBuffer, sizeof(int))) {
 		return false;
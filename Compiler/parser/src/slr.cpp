@@ -0,0 +1,90 @@
+#include "slr.h"
+#include "debug.h"
+#include "grammar.h"
+
+SLR::SLR(bool fallback) : fallback_(fallback) {
+}
+
+SLR::~SLR() {
+}
+
+void SLR::CalculateForwards() {
+	ForwardsVector follows(symbolCount_);
+	for (GrammarSymbolSetTable::const_iterator ite = followSets_->begin(); ite != followSets_->end(); ++ite) {
+		for (GrammarSymbolSet::const_iterator ite2 = ite->second.begin(); ite2 != ite->second.end(); ++ite2) {
+			follows[ite->first.GetID()].insert(*ite2);
+		}
+	}
+
+	for (int i = 0; i < (int)states_.size(); ++i) {
+		const LR1Itemset& itemset = states_[i];
+		for (int j = 0; j < itemset.size(); ++j) {
+			if (!condinates_->IsReduction(itemset[j].GetCpos(), itemset[j].GetDpos())) {
+				continue;
+			}
+
+			Grammar* g = nullptr;
+			env_->grammars.GetTargetCondinate(itemset[j].GetCpos(), &g);
+
+			// program is not in a closure, the items of the start state only follow a nullable prefix.
+			if (i == 0 && g->GetLhs() == env_->program) {
+				continue;
+			}
+
+			forwards_[itemIDs_[i] + j] = follows[g->GetLhs().GetID()];
+		}
+	}
+}
+
+bool SLR::CreateLRParsingTable(LRGotoTable& gotoTable, LRActionTable& actionTable) {
+	int conflicts = 0;
+	for (int i = 0; i < (int)states_.size(); ++i) {
+		if (HasConflict(i)) {
+			++conflicts;
+		}
+	}
+
+	if (conflicts == 0) {
+		Debug::Log("grammar is SLR(1).");
+	}
+	else {
+		Debug::Log(Utility::Format("grammar is not SLR(1), %d of %d states have conflicts.", conflicts, (int)states_.size()));
+		if (!fallback_) {
+			return false;
+		}
+
+		CreateItemIDs();
+		DPLALR::CalculateForwards();
+		InternForwards();
+	}
+
+	return LALR::CreateLRParsingTable(gotoTable, actionTable);
+}
+
+bool SLR::HasConflict(int state) const {
+	// terminals having an action so far.
+	Forwards terminals;
+	for (int id = 0; id < env_->TerminalCount(); ++id) {
+		if (edges_.get(state, id) >= 0) {
+			terminals.insert(env_->symbols[id]);
+		}
+	}
+
+	const LR1Itemset& itemset = states_[state];
+	for (int j = 0; j < itemset.size(); ++j) {
+		if (!condinates_->IsReduction(itemset[j].GetCpos(), itemset[j].GetDpos())) {
+			continue;
+		}
+
+		const Forwards& forwards = GetForwards(itemIDs_[state] + j);
+		for (Forwards::const_iterator ite = forwards.begin(); ite != forwards.end(); ++ite) {
+			if (terminals.contains(env_->symbols[*ite])) {
+				return true;
+			}
+		}
+
+		terminals.merge(forwards);
+	}
+
+	return false;
+}
@@ -68,6 +68,10 @@ void Syntaxer::Setup(const SyntaxerSetupParameter& p) {
 	p_ = p;
 }
 
+void Syntaxer::Compact() {
+	p_.lrTable.Compact();
+}
+
 bool Syntaxer::Load(std::ifstream& file) {
 	return Serializer::LoadSyntaxer(file, p_);
 }
@@ -102,6 +106,7 @@ int Syntaxer::Reduce(int cpos) {
 	void* newValue = (cond->action != nullptr) ? cond->action->Invoke(stack_->values) : nullptr;
 
 	stack_->pop(length);
+	Assert(stack_->states.back() >= 0, "reduction of " + g->GetLhs().ToString() + " exposes a shift-reduce state.");
 
 	int nextState = p_.lrTable.GetGoto(stack_->states.back(), g->GetLhs());
 	Debug::Log(log + "Goto state " + std::to_string(nextState) + ".");
@@ -125,21 +130,37 @@ void Syntaxer::Shift(int state, void* addr, const GrammarSymbol& symbol) {
 	stack_->push(state, addr, symbol);
 }
 
+int Syntaxer::ShiftReduce(int cpos, void* addr, const GrammarSymbol& symbol) {
+	Debug::Log(">> [SR] `" + symbol.ToString() + "`.");
+
+	// the state is popped by the reduction at once, see LRTable::CreateShiftReductions.
+	stack_->push(-1, addr, symbol);
+	return Reduce(cpos);
+}
+
 bool Syntaxer::CreateSyntaxTree(SyntaxNode*& root, FileScanner* fileScanner) {
 	TokenPosition position = { 0 };
 
 	stack_->push(0, nullptr, NativeSymbols::zero);
-	LRAction action = { LRActionShift };
+	LRAction action = { LRActionError };
 
 	void* addr = nullptr;
 	GrammarSymbol symbol = nullptr;
 
 	do {
-		if (action.type == LRActionShift && !(symbol = ParseNextSymbol(position, addr, fileScanner))) {
-			break;
+		// the lookahead is read only when the action depends on it.
+		int cpos = p_.lrTable.GetLR0Reduction(stack_->states.back());
+		if (cpos >= 0) {
+			action.type = LRActionReduce;
+			action.parameter = cpos;
 		}
+		else {
+			if (!symbol && !(symbol = ParseNextSymbol(position, addr, fileScanner))) {
+				break;
+			}
 
-		action = p_.lrTable.GetAction(stack_->states.back(), symbol);
+			action = p_.lrTable.GetAction(stack_->states.back(), symbol);
+		}
 
 		if (action.type == LRActionError && !Error(symbol, position)) {
 			break;
@@ -147,12 +168,20 @@ bool Syntaxer::CreateSyntaxTree(SyntaxNode*& root, FileScanner* fileScanner) {
 
 		if (action.type == LRActionShift) {
 			Shift(action.parameter, addr, symbol);
+			symbol = nullptr;
 		}
 		else if (action.type == LRActionReduce) {
 			if (!Reduce(action.parameter)) {
 				break;
 			}
 		}
+		else if (action.type == LRActionShiftReduce) {
+			if (!ShiftReduce(action.parameter, addr, symbol)) {
+				break;
+			}
+
+			symbol = nullptr;
+		}
 
 	} while (action.type != LRActionAccept);
 
@@ -194,6 +223,7 @@ GrammarSymbol Syntaxer::FindSymbol(const ScannerToken& token, void*& addr) {
 	}
 
 	Assert(answer != NativeSymbols::null, std::string("can not find symbol") + token.text);
+	Assert(p_.env->symbols[answer.GetID()] == answer, "symbol " + answer.ToString() + " is not of this environment.");
 
 	return answer;
 }
@@ -0,0 +1,31 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "lr_impl.h"
+
+class Language;
+
+struct TestInput;
+struct TestGrammar;
+
+// Parses small grammars with every LRImplType and LRTableEncoding, both with the
+// tables just built and with them saved and loaded again. Every configuration
+// must accept the same inputs, build the same syntax trees and save the same tables.
+class LanguageTest {
+public:
+	// returns whether every case passed.
+	static bool Run();
+
+private:
+	// trees[i] is the tree of the i-th input of grammar, empty until a configuration accepts it.
+	// table is what LALR saves with encoding, the other types must save the same for these grammars.
+	static bool RunGrammar(const TestGrammar& grammar, LRImplType type, LRTableEncoding encoding, std::vector<std::string>& trees, std::string& table);
+	static bool RunInput(Language& language, const TestInput& input, std::string& tree, const std::string& name);
+
+	// a language must keep working after another one is set up.
+	static bool RunLanguages();
+
+	static void WriteInput(const char* text);
+	static std::string ReadCompilerFile();
+};
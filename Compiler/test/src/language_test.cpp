@@ -0,0 +1,251 @@
+#include <fstream>
+#include <sstream>
+
+#include "debug.h"
+#include "utilities.h"
+#include "language.h"
+#include "syntax_tree.h"
+#include "language_test.h"
+
+static const char* inputFile = "main/debug/test_input.txt";
+static const char* compilerFile = "main/debug/test_compiler";
+
+enum {
+	MaxTestInputs = 6,
+};
+
+struct TestInput {
+	const char* text;
+	bool accepted;
+};
+
+struct TestGrammar {
+	const char* name;
+	const char* productions;
+
+	// whether LRImplSLR builds it without conflicts.
+	bool slr;
+
+	// terminated by a null text.
+	TestInput inputs[MaxTestInputs + 1];
+};
+
+static const TestGrammar grammars[] = {
+	{
+		// SLR(1), with chains of unit reductions.
+		"expression",
+		"Program\n"
+		"	: Expression		$$ = $1\n"
+		"\n"
+		"Expression\n"
+		"	: Expression + Term	$$ = make(\"+\", $3, $1)\n"
+		"	| Term			$$ = $1\n"
+		"\n"
+		"Term\n"
+		"	: Term * Factor		$$ = make(\"*\", $3, $1)\n"
+		"	| Factor		$$ = $1\n"
+		"\n"
+		"Factor\n"
+		"	: ( Expression )	$$ = $2\n"
+		"	| number		$$ = constant($1)\n",
+		true,
+		{
+			{ "1 + 2 * ( 3 + 4 )", true },
+			{ "( ( 5 ) )", true },
+			{ "1 + * 2", false },
+			{ "( 1 + 2", false },
+			{ nullptr, false },
+		},
+	},
+	{
+		// LALR(1) but not SLR(1).
+		"assignment",
+		"Program\n"
+		"	: Statement		$$ = $1\n"
+		"\n"
+		"Statement\n"
+		"	: Left = Right		$$ = make(\"=\", $3, $1)\n"
+		"	| Right			$$ = $1\n"
+		"\n"
+		"Left\n"
+		"	: * Right		$$ = make(\"*\", $2)\n"
+		"	| identifier		$$ = symbol($1)\n"
+		"\n"
+		"Right\n"
+		"	: Left			$$ = $1\n",
+		false,
+		{
+			{ "* a = * * b", true },
+			{ "a", true },
+			{ "a = = b", false },
+			{ "* = b", false },
+			{ nullptr, false },
+		},
+	},
+	{
+		// empty reductions right after a shift, the only action of the state after "[".
+		"epsilon",
+		"Program\n"
+		"	: Block			$$ = $1\n"
+		"\n"
+		"Block\n"
+		"	: ( Items )		$$ = $2\n"
+		"	| [ Empty ]		$$ = $2\n"
+		"\n"
+		"Empty\n"
+		"	: epsilon		$$ = make(\"empty\")\n"
+		"\n"
+		"Items\n"
+		"	: epsilon		$$ = make(\"empty\")\n"
+		"	| Item Items		$$ = make(\"items\", $2, $1)\n"
+		"\n"
+		"Item\n"
+		"	: number		$$ = constant($1)\n",
+		true,
+		{
+			{ "( )", true },
+			{ "( 1 2 )", true },
+			{ "[ ]", true },
+			{ "( ) )", false },
+			{ "( 1", false },
+			{ "[ 1 ]", false },
+			{ nullptr, false },
+		},
+	},
+	{
+		// Program derives epsilon, the empty reduction in the start state must not collide with an accept.
+		"nullable program",
+		"Program\n"
+		"	: Numbers		$$ = $1\n"
+		"\n"
+		"Numbers\n"
+		"	: epsilon		$$ = make(\"empty\")\n"
+		"	| Number Numbers	$$ = make(\"numbers\", $2, $1)\n"
+		"\n"
+		"Number\n"
+		"	: number		$$ = constant($1)\n",
+		true,
+		{
+			{ "", true },
+			{ "1 2 3", true },
+			{ "1 a", false },
+			{ "a", false },
+			{ nullptr, false },
+		},
+	},
+};
+
+static const LRImplType types[] = { LRImplLALR, LRImplDPLALR, LRImplLazyDPLALR, LRImplPager, LRImplSLR, LRImplAuto };
+// indexed by LRImplType and LRTableEncoding.
+static const char* typeNames[] = { "LALR", "DPLALR", "LazyDPLALR", "Pager", "SLR", "Auto" };
+
+static const LRTableEncoding encodings[] = { LRTableDense, LRTablePacked };
+static const char* encodingNames[] = { "dense", "packed" };
+
+bool LanguageTest::Run() {
+	int failures = 0, cases = 0;
+	int grammarCount = sizeof(grammars) / sizeof(grammars[0]);
+	int typeCount = sizeof(types) / sizeof(types[0]);
+	int encodingCount = sizeof(encodings) / sizeof(encodings[0]);
+
+	for (int i = 0; i < grammarCount; ++i) {
+		std::vector<std::string> trees(MaxTestInputs);
+		std::vector<std::string> tables(encodingCount);
+		for (int j = 0; j < typeCount; ++j) {
+			if (types[j] == LRImplSLR && !grammars[i].slr) {
+				continue;
+			}
+
+			for (int k = 0; k < encodingCount; ++k) {
+				++cases;
+				failures += RunGrammar(grammars[i], types[j], encodings[k], trees, tables[k]) ? 0 : 1;
+			}
+		}
+	}
+
+	++cases;
+	failures += RunLanguages() ? 0 : 1;
+
+	if (failures != 0) {
+		Debug::LogError(Utility::Format("%d of %d test cases failed.", failures, cases));
+		return false;
+	}
+
+	Debug::Log(Utility::Format("%d test cases passed.", cases));
+	return true;
+}
+
+bool LanguageTest::RunGrammar(const TestGrammar& grammar, LRImplType type, LRTableEncoding encoding, std::vector<std::string>& trees, std::string& table) {
+	std::string name = std::string(grammar.name) + " (" + typeNames[type] + ", " + encodingNames[encoding] + ")";
+
+	Language built(type, encoding);
+	built.Setup(grammar.productions, compilerFile);
+
+	Language loaded;
+	loaded.Load(compilerFile);
+
+	bool status = true;
+	if (type == LRImplLALR) {
+		table = ReadCompilerFile();
+	}
+	else if (ReadCompilerFile() != table) {
+		Debug::LogError(name + ": the saved tables differ from the ones of LALR.");
+		status = false;
+	}
+
+	for (int i = 0; grammar.inputs[i].text != nullptr; ++i) {
+		status = RunInput(built, grammar.inputs[i], trees[i], name) && status;
+		status = RunInput(loaded, grammar.inputs[i], trees[i], name + " loaded") && status;
+	}
+
+	return status;
+}
+
+bool LanguageTest::RunInput(Language& language, const TestInput& input, std::string& tree, const std::string& name) {
+	WriteInput(input.text);
+
+	SyntaxTree answer;
+	bool accepted = language.Parse(&answer, inputFile);
+	if (accepted != input.accepted) {
+		Debug::LogError(name + ": \"" + input.text + "\" is " + (accepted ? "accepted." : "rejected."));
+		return false;
+	}
+
+	if (!accepted) {
+		return true;
+	}
+
+	if (tree.empty()) {
+		tree = answer.ToString();
+	}
+	else if (tree != answer.ToString()) {
+		Debug::LogError(name + ": \"" + input.text + "\" has a different syntax tree:\n" + answer.ToString());
+		return false;
+	}
+
+	return true;
+}
+
+bool LanguageTest::RunLanguages() {
+	Language first;
+	first.Setup(grammars[0].productions, compilerFile);
+
+	// the symbols of first must keep their ids.
+	Language second;
+	second.Setup(grammars[1].productions, compilerFile);
+
+	std::string tree;
+	return RunInput(first, grammars[0].inputs[0], tree, "two languages");
+}
+
+void LanguageTest::WriteInput(const char* text) {
+	std::ofstream file(inputFile);
+	file << text << "\n";
+}
+
+std::string LanguageTest::ReadCompilerFile() {
+	std::ifstream file(compilerFile, std::ios::binary);
+	std::ostringstream stream;
+	stream << file.rdbuf();
+	return stream.str();
+}